@@ -0,0 +1,212 @@
+// Request latency of HttpClient over TCP loopback and over a unix domain socket, against a local stand-in for an
+// Unleash Edge sidecar that answers every request with the same frontend API payload.
+//
+// Usage: transport_bench [requests per case, default 2000]
+//
+// Each transport is measured with kept-alive connections (the steady state of polling) and with a new connection
+// per request (the server closes it), which is where the TCP setup cost shows.
+
+#include "unleash/Transport/httpClient.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+std::string makePayload() {
+    std::string toggles;
+    for (int i = 0; i < 20; ++i) {
+        if (i)
+            toggles += ',';
+        toggles += R"({"name":"toggle-)" + std::to_string(i) +
+                   R"(","enabled":true,"variant":{"name":"disabled","enabled":false},"impressionData":false})";
+    }
+    return R"({"toggles":[)" + toggles + "]}";
+}
+
+class StandInServer {
+  public:
+    explicit StandInServer(std::string p_socketPath) : _socketPath(std::move(p_socketPath)), _payload(makePayload()) {
+        _tcp = ::socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        ::setsockopt(_tcp, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in in{};
+        in.sin_family = AF_INET;
+        in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(in);
+        if (::bind(_tcp, reinterpret_cast<sockaddr*>(&in), sizeof(in)) != 0 || ::listen(_tcp, 64) != 0 ||
+            ::getsockname(_tcp, reinterpret_cast<sockaddr*>(&in), &len) != 0) {
+            std::perror("tcp listen");
+            std::exit(1);
+        }
+        _port = ntohs(in.sin_port);
+
+        ::unlink(_socketPath.c_str());
+        _unix = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un un{};
+        un.sun_family = AF_UNIX;
+        std::strncpy(un.sun_path, _socketPath.c_str(), sizeof(un.sun_path) - 1);
+        if (::bind(_unix, reinterpret_cast<sockaddr*>(&un), sizeof(un)) != 0 || ::listen(_unix, 64) != 0) {
+            std::perror("unix listen");
+            std::exit(1);
+        }
+
+        _acceptor = std::thread([this] { acceptLoop(); });
+    }
+
+    ~StandInServer() {
+        _running.store(false);
+        _acceptor.join();
+        for (auto& connection : _connections)
+            connection.join();
+        ::close(_tcp);
+        ::close(_unix);
+        ::unlink(_socketPath.c_str());
+    }
+
+    int port() const {
+        return _port;
+    }
+
+    void setCloseAfterResponse(bool p_close) {
+        _close.store(p_close);
+    }
+
+  private:
+    void acceptLoop() {
+        pollfd fds[2] = {{_tcp, POLLIN, 0}, {_unix, POLLIN, 0}};
+        while (_running.load()) {
+            if (::poll(fds, 2, 50) <= 0)
+                continue;
+            for (const auto& fd : fds) {
+                if (!(fd.revents & POLLIN))
+                    continue;
+                const int client = ::accept(fd.fd, nullptr, nullptr);
+                if (client < 0)
+                    continue;
+                if (fd.fd == _tcp) {
+                    int one = 1;
+                    ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                }
+                _connections.emplace_back([this, client] { serve(client); });
+            }
+        }
+    }
+
+    void serve(int p_client) {
+        std::string pending;
+        char buf[4096];
+        for (;;) {
+            std::size_t end;
+            while ((end = pending.find("\r\n\r\n")) == std::string::npos) {
+                const auto n = ::recv(p_client, buf, sizeof(buf), 0);
+                if (n <= 0) {
+                    ::close(p_client);
+                    return;
+                }
+                pending.append(buf, static_cast<std::size_t>(n));
+            }
+            pending.erase(0, end + 4);
+
+            const bool close = _close.load();
+            std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: W/\"bench\"\r\n";
+            response += close ? "Connection: close\r\n" : "Connection: keep-alive\r\n";
+            response += "Content-Length: " + std::to_string(_payload.size()) + "\r\n\r\n";
+            response += _payload;
+            ::send(p_client, response.data(), response.size(), MSG_NOSIGNAL);
+            if (close) {
+                ::close(p_client);
+                return;
+            }
+        }
+    }
+
+    std::string _socketPath;
+    std::string _payload;
+    int _tcp = -1;
+    int _unix = -1;
+    int _port = 0;
+    std::atomic<bool> _running{true};
+    std::atomic<bool> _close{false};
+    std::thread _acceptor;
+    std::vector<std::thread> _connections; // only touched by the acceptor thread until it is joined
+};
+
+struct Summary {
+    double mean;
+    double p50;
+    double p99;
+};
+
+Summary measure(const std::string& p_url, const std::string& p_socketPath, int p_requests) {
+    unleash::HttpClient client;
+    unleash::HttpRequest req;
+    req.url = p_url;
+    req.timeoutMs = 5000;
+    req.unixSocketPath = p_socketPath;
+    req.headers["accept"] = "application/json";
+    req.headers["authorization"] = "bench-key";
+
+    std::vector<double> micros;
+    micros.reserve(static_cast<std::size_t>(p_requests));
+    for (int i = -p_requests / 10; i < p_requests; ++i) { // the first 10% warm up
+        const auto started = std::chrono::steady_clock::now();
+        auto resp = client.request(req);
+        const auto elapsed = std::chrono::steady_clock::now() - started;
+        auto* http = dynamic_cast<unleash::HttpResponse*>(resp.get());
+        if (!http || http->status != 200) {
+            std::fprintf(stderr, "request failed: %s\n", http ? http->errorMessage.c_str() : "no response");
+            std::exit(1);
+        }
+        client.recycleBody(std::move(http->body));
+        if (i >= 0)
+            micros.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+
+    std::sort(micros.begin(), micros.end());
+    double sum = 0;
+    for (double m : micros)
+        sum += m;
+    const auto at = [&](double q) { return micros[static_cast<std::size_t>(q * (micros.size() - 1))]; };
+    return {sum / static_cast<double>(micros.size()), at(0.5), at(0.99)};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int requests = argc > 1 ? std::max(10, std::atoi(argv[1])) : 2000;
+    const std::string socketPath = "/tmp/unleash-bench-" + std::to_string(::getpid()) + ".sock";
+
+    StandInServer server(socketPath);
+    const std::string tcpUrl = "http://127.0.0.1:" + std::to_string(server.port()) + "/api/frontend";
+    const std::string unixUrl = "http://localhost/api/frontend";
+
+    std::printf("%d requests per case, latency in microseconds\n", requests);
+    std::printf("%-28s %10s %10s %10s\n", "case", "mean", "p50", "p99");
+    for (bool close : {false, true}) {
+        server.setCloseAfterResponse(close);
+        const char* mode = close ? "new connection" : "keep-alive";
+        for (bool overUnix : {false, true}) {
+            const auto s = measure(overUnix ? unixUrl : tcpUrl, overUnix ? socketPath : std::string(), requests);
+            const std::string name = std::string(overUnix ? "unix socket, " : "tcp loopback, ") + mode;
+            std::printf("%-28s %10.1f %10.1f %10.1f\n", name.c_str(), s.mean, s.p50, s.p99);
+        }
+    }
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "unleash/Client/unleashClient.hpp"
+#include "unleash/Configuration/clientConfig.hpp"
 
 #include <chrono>
 #include <cstdlib>
@@ -37,7 +38,7 @@ int main() {
 
     client.onUpdate([]() { std::cout << "[update] toggles changed" << std::endl; });
 
-    client.onError([](const unleash::EventHandler::ClientError& e) {
+    client.onError([](const unleash::ClientError& e) {
         std::cerr << "[error] " << e.message << ": " << e.details << std::endl;
     });
 
@@ -1,27 +1,21 @@
 #pragma once
 
-#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
-#include <utility>
-#include <thread>
-#include <optional>
-#include "unleash/EventHandler/eventHandler.hpp"
-#include "unleash/Configuration/clientConfig.hpp"
 #include "unleash/Domain/context.hpp"
-#include "unleash/Domain/toggleSet.hpp"
 #include "unleash/Domain/variant.hpp"
-#include "unleash/EventHandler/eventHandler.hpp"
-#include "unleash/Store/flagStore.hpp"
-#include "unleash/Metrics/metricStore.hpp"
-#include "unleash/Metrics/metricSender.hpp"
-#include "unleash/Fetcher/toggleFetcher.hpp"
-#include "unleash/Store/storageProvider.hpp"
+#include "unleash/EventHandler/clientEvents.hpp"
 
 namespace unleash {
 
+// Only needed where the client is built: include "unleash/Configuration/clientConfig.hpp" there.
+class ClientConfig;
+
 enum class SdkState : std::uint8_t { Started, Healthy, Error, Stopped };
 
+// Stores, fetcher, sender and threads live behind a private implementation (src/internal/unleashClientImpl.hpp):
+// this header only exposes evaluation, context and callbacks, and its layout does not change with them.
 class UnleashClient {
   public:
     explicit UnleashClient(ClientConfig p_config, Context p_ctx);
@@ -47,55 +41,32 @@ class UnleashClient {
     void updateContext(const MutableContext& p_mCtx);
 
     // Callback setters
-    UnleashClient& onInit(EventHandler::InitCallback cb);
-    UnleashClient& onError(EventHandler::ErrorCallback cb);
-    UnleashClient& onReady(EventHandler::ReadyCallback cb);
-    UnleashClient& onUpdate(EventHandler::UpdateCallback cb);
-    UnleashClient& onImpression(EventHandler::ImpressionCallback cb);
+    UnleashClient& onInit(InitCallback cb);
+    UnleashClient& onError(ErrorCallback cb);
+    UnleashClient& onReady(ReadyCallback cb);
+    UnleashClient& onUpdate(UpdateCallback cb);
+    UnleashClient& onImpression(ImpressionCallback cb);
+    // Circuit breaker transitions of the toggle and metrics endpoints (see ClientConfig::setCircuitBreaker):
+    UnleashClient& onCircuitStateChange(CircuitStateCallback cb);
+    UnleashClient& onImpressionBatch(ImpressionBatchCallback cb, std::size_t maxBatch = utils::impressionBatchSize,
+                                     utils::mSeconds maxDelay = utils::impressionBatchDelay);
+
+    // Additional listeners: onX() keeps replacing its single callback, these ones add up until removed.
+    ListenerToken addInitListener(InitCallback cb);
+    ListenerToken addErrorListener(ErrorCallback cb);
+    ListenerToken addReadyListener(ReadyCallback cb);
+    ListenerToken addUpdateListener(UpdateCallback cb);
+    ListenerToken addImpressionListener(ImpressionCallback cb);
+    ListenerToken addCircuitStateChangeListener(CircuitStateCallback cb);
+    bool removeListener(ListenerToken token);
+
+    // Enqueued/dropped/coalesced/dispatched counters and dispatch latency of the event queue, per event type.
+    EventStats eventStats() const;
+
+    class Impl;
 
   private:
-    bool isStoreReady();
-
-    void initializeToggleCache();
-
-    // void applyBootstrap(bool hasStoredToggles);
-
-    void persistToggles(const ToggleSet& p_toggles);
-
-    void featurePollingLoop();
-
-    void metricSendingLoop();
-
-    std::optional<MetricSender::MetricResult> sendMetrics();
-
-    void singleFetchToggles(const Context& p_ctx);
-
-    ClientConfig _config;
-    Context _context;
-    // stores:
-    FlagStore _flagStore;
-    MetricsStore _metricStore;
-    // senders:
-    MetricSender _metricSender;
-    // toggle Fetcher:
-    ToggleFetcher _toggleFetcher;
-    // even handler:
-    std::shared_ptr<EventHandler> _eventHandler;
-
-    std::atomic_bool _running{false};
-    std::atomic_bool _ready{false};
-    std::atomic_bool _exitThreads{false};
-    bool _contextUpdated{false};
-
-    // Thread variables:
-    std::thread _fPollingThread;
-    std::thread _mSendingThread;
-    // multithreading Data race handling :
-    std::condition_variable _cvMetrics, _cvPolling;
-    std::mutex _mutexMetrics, _mutexPolling;
-
-    // sdkState:
-    SdkState _sdkState{SdkState::Stopped};
+    std::unique_ptr<Impl> _impl;
 };
 
-} // namespace unleash
\ No newline at end of file
+} // namespace unleash
@@ -6,14 +6,21 @@
 #include <chrono>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "unleash/Domain/context.hpp"
 #include "unleash/Domain/toggleSet.hpp"
+#include "unleash/EventHandler/clientEvents.hpp"
 #include "unleash/Utils/utils.hpp"
 #include "unleash/Store/storageProvider.hpp"
 
 namespace unleash {
 
+class SharedToggleSegment;
+class SharedMetricsSegment;
+class IScheduler;
+
 class Bootstrap final {
   public:
     explicit Bootstrap(ToggleSet::Map p_map);
@@ -29,21 +36,64 @@ class ClientConfig final {
     ClientConfig(const std::string& p_url, const std::string& p_clientKey, const std::string& p_appName);
     // setters:
     ClientConfig& setInstanceId(const std::string& p_instanceId);
+    // Several frontend endpoints (e.g. one Edge per zone), replacing the constructor url; the first one becomes url().
+    // Toggles are fetched from the fastest healthy one, with an immediate failover on transport errors.
+    ClientConfig& setUrls(std::vector<std::string> p_urls);
     ClientConfig& setRefreshInterval(utils::seconds s);
     ClientConfig& setMetricsInterval(utils::seconds s);
     ClientConfig& setMetricsIntervalInitial(utils::seconds s);
+    // Failed polls back off with full jitter up to this delay (never below the refresh interval). Also caps the wait
+    // a server's Retry-After/RateLimit-Reset asks for.
+    ClientConfig& setPollBackoffMax(utils::seconds s);
+    // The first poll waits a random delay in [0, m] (0: polls right away).
+    ClientConfig& setPollStartupJitter(utils::mSeconds m);
     ClientConfig& setBootstrap(Bootstrap b);
     ClientConfig& setBootstrapOverride(bool v);
     ClientConfig& setHeaderName(std::string headerName);
     ClientConfig& setCustomHeaders(std::map<std::string, std::string> headers);
     ClientConfig& setImpressionDataAll(bool v);
+    // Impression sampling (applied before an impression is built): sample rates in [0, 1], at most n impressions per
+    // flag and interval, and no repeat of the same (flag, enabled, variant) within the dedup window.
+    ClientConfig& setImpressionSampleRate(double rate);
+    ClientConfig& setFlagImpressionSampleRate(const std::string& flagName, double rate);
+    ClientConfig& setImpressionFirstN(std::size_t n, utils::mSeconds interval);
+    ClientConfig& setImpressionDedupWindow(utils::mSeconds m);
     ClientConfig& setUsePostRequests(bool v);
+    // Fetch for a new context only once updateContext() calls have been quiet for this long (0: right away).
+    ClientConfig& setContextUpdateDebounce(utils::mSeconds m);
     ClientConfig& setTimeOutQueryMS(utils::mSeconds m);
+    // Connect to the toggle and metrics endpoints while the storage backup loads, so that the first fetch does not
+    // pay for DNS, TCP and TLS (default: false).
+    ClientConfig& setPreconnect(bool v);
+    // Toggle fetches and metrics go through this unix domain socket (e.g. of an Unleash Edge sidecar) instead of
+    // TCP; the urls still give the Host header and the paths. Empty, the default: TCP.
+    ClientConfig& setUnixSocketPath(std::string path);
+    // When a toggle fetch has not completed within this quantile of the observed latencies (e.g. 0.95), a duplicate
+    // request goes to another endpoint (or the same one) and the first answer wins. initialDelay applies until
+    // enough latencies are observed (0: no hedge until then). A quantile of 0 disables hedging.
+    ClientConfig& setFetchHedging(double quantile, utils::mSeconds initialDelay);
+    // After failureThreshold consecutive failures, calls to the toggle or metrics endpoint are skipped for
+    // openDuration, then a single probe decides whether to resume (0: no circuit breaker).
+    ClientConfig& setCircuitBreaker(std::size_t failureThreshold, utils::mSeconds openDuration);
+    // stop() aborts in-flight requests, then sends the remaining metrics once within this deadline (0: disabled).
+    ClientConfig& setMetricsFlushOnStop(utils::mSeconds deadline);
+    // Event queue: capacity (rounded up to a power of two), what to do when it is full, and how long Block waits.
+    ClientConfig& setEventQueueCapacity(std::size_t capacity);
+    ClientConfig& setEventOverflowPolicy(EventOverflowPolicy policy);
+    ClientConfig& setEventBlockTimeout(utils::mSeconds m);
 
     ClientConfig& setStorageProvider(std::shared_ptr<IStorageProvider> provider);
+    // Publisher segments (SharedToggleSegment::create) receive every fetched snapshot, reader segments
+    // (SharedToggleSegment::open) feed the FlagStore, in which case polling should be disabled.
+    ClientConfig& setSharedToggleSegment(std::shared_ptr<SharedToggleSegment> segment);
+    // Evaluations are counted in the shared segment and only the elected process sends metrics for the host.
+    ClientConfig& setSharedMetricsSegment(std::shared_ptr<SharedMetricsSegment> segment);
+    // Polling, metrics and callback dispatch run as tasks on this scheduler instead of threads owned by the client.
+    ClientConfig& setScheduler(std::shared_ptr<IScheduler> scheduler);
 
     // getters:
     const std::string& url() const;
+    const std::vector<std::string>& urls() const;
     const std::string& clientKey() const;
     const std::string& appName() const;
     const std::string& connectionId() const;
@@ -51,23 +101,45 @@ class ClientConfig final {
     utils::seconds refreshInterval() const;
     utils::seconds metricsInterval() const;
     utils::seconds metricsIntervalInitial() const;
+    utils::seconds pollBackoffMax() const;
+    utils::mSeconds pollStartupJitter() const;
     const std::optional<Bootstrap>& bootstrap() const;
     bool bootstrapOverride() const;
     const std::string& headerName() const;
     const std::map<std::string, std::string>& customHeaders() const;
     bool impressionDataAll() const;
+    double impressionSampleRate() const;
+    const std::unordered_map<std::string, double>& flagImpressionSampleRates() const;
+    std::size_t impressionFirstN() const;
+    utils::mSeconds impressionFirstNInterval() const;
+    utils::mSeconds impressionDedupWindow() const;
     bool usePostRequests() const;
+    utils::mSeconds contextUpdateDebounce() const;
     utils::mSeconds timeOutQueryMS() const;
+    bool preconnect() const;
+    const std::string& unixSocketPath() const;
+    double fetchHedgePercentile() const;
+    utils::mSeconds fetchHedgeInitialDelay() const;
+    utils::mSeconds metricsFlushOnStop() const;
+    std::size_t circuitBreakerThreshold() const;
+    utils::mSeconds circuitBreakerOpenDuration() const;
+    std::size_t eventQueueCapacity() const;
+    EventOverflowPolicy eventOverflowPolicy() const;
+    utils::mSeconds eventBlockTimeout() const;
 
     bool isRefreshEnabled() const;
     bool isMetricsEnabled() const;
 
     std::shared_ptr<IStorageProvider> storageProvider() const;
+    std::shared_ptr<SharedToggleSegment> sharedToggleSegment() const;
+    std::shared_ptr<SharedMetricsSegment> sharedMetricsSegment() const;
+    std::shared_ptr<IScheduler> scheduler() const;
 
     bool isValid();
 
   private:
     std::string _url;
+    std::vector<std::string> _urls;
     std::string _clientKey;
     std::string _appName;
     std::string _connectionId;
@@ -75,16 +147,39 @@ class ClientConfig final {
     utils::seconds _refreshInterval{15};
     utils::seconds _metricsInterval{60};
     utils::seconds _metricsIntervalInitial{0};
+    utils::seconds _pollBackoffMax{utils::pollBackoffMax};
+    utils::mSeconds _pollStartupJitter{0};
     std::optional<Bootstrap> _bootstrap{};
     bool _bootstrapOverride{true};
     std::string _headerName = std::string(utils::defaultHeadeName);
     std::map<std::string, std::string> _customHeaders{};
     bool _impressionDataAll{false};
+    double _impressionSampleRate{1.0};
+    std::unordered_map<std::string, double> _flagImpressionSampleRates{};
+    std::size_t _impressionFirstN{0};
+    utils::mSeconds _impressionFirstNInterval{0};
+    utils::mSeconds _impressionDedupWindow{0};
     bool _usePostRequests{false};
+    utils::mSeconds _contextUpdateDebounce{0};
     std::string _instanceId = std::string(utils::defaultInstanceId);
     utils::mSeconds _timeOutQueryMS{5000};
+    bool _preconnect{false};
+    std::string _unixSocketPath;
+    double _fetchHedgePercentile{0.0};
+    utils::mSeconds _fetchHedgeInitialDelay{0};
+    utils::mSeconds _metricsFlushOnStop{0};
+    std::size_t _circuitBreakerThreshold{0};
+    utils::mSeconds _circuitBreakerOpenDuration{0};
+    std::size_t _eventQueueCapacity{utils::maxEventQueueSize};
+    EventOverflowPolicy _eventOverflowPolicy{EventOverflowPolicy::DropNewest};
+    utils::mSeconds _eventBlockTimeout{utils::eventBlockTimeout};
     // StorageProvider:
     std::shared_ptr<IStorageProvider> _storageProvider;
+    // Cross-process snapshot:
+    std::shared_ptr<SharedToggleSegment> _sharedToggleSegment;
+    std::shared_ptr<SharedMetricsSegment> _sharedMetricsSegment;
+    // Executor of the background work (nullptr: a ThreadScheduler per job, owned by the client):
+    std::shared_ptr<IScheduler> _scheduler;
 };
 
 } // namespace unleash
\ No newline at end of file
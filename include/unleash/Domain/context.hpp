@@ -4,6 +4,7 @@
 #include <string>
 #include <utility>
 #include <chrono>
+#include <cstdint>
 #include <vector>
 #include <string_view>
 #include "unleash/Utils/utils.hpp"
@@ -28,6 +29,13 @@ class MutableContext final {
     const std::optional<std::string>& getCurrentTime() const;
     const utils::contextProperties& getProperties() const;
 
+    // FNV-1a over all fields; equal for contexts that encode to the same request (property order is ignored).
+    std::uint64_t fingerprint() const;
+
+    // Field-wise comparison (property order is ignored), exact where fingerprint() may collide.
+    bool operator==(const MutableContext& p_other) const;
+    bool operator!=(const MutableContext& p_other) const;
+
   private:
     std::optional<std::string> _userId;
     std::optional<std::string> _remoteAddress;
@@ -44,12 +52,13 @@ class Context final {
 
     const std::string& getAppName() const;
     const std::string& getSessionId() const;
-    const std::optional<std::string> getEnvironment() const;
+    const std::optional<std::string>& getEnvironment() const;
 
-    const std::optional<std::string> getUserId() const;
-    const std::optional<std::string> getRemoteAddress() const;
-    const std::optional<std::string> getCurrentTime() const;
-    const utils::contextProperties getProperties() const;
+    const std::optional<std::string>& getUserId() const;
+    const std::optional<std::string>& getRemoteAddress() const;
+    const std::optional<std::string>& getCurrentTime() const;
+    const utils::contextProperties& getProperties() const;
+    const MutableContext& getMutableContext() const;
 
     Context& setUserId(const std::string& p_userId);
     Context& setRemoteAddress(const std::string& p_remoteAddress);
@@ -58,6 +67,9 @@ class Context final {
 
     void updateMutableContext(const MutableContext& p_mutableContext);
 
+    // Fingerprint of the mutable part, the only one updateContext() can change.
+    std::uint64_t fingerprint() const;
+
   private:
     void resolveSessionId();
     std::string _appName;
@@ -0,0 +1,86 @@
+// clientEvents.hpp
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "unleash/Domain/context.hpp"
+
+namespace unleash {
+
+enum class ClientEvent : std::uint8_t { Init, Error, Ready, Update, Impression, CircuitStateChange };
+
+inline constexpr std::size_t clientEventCount = 6;
+
+// What an emit does when the event queue is full:
+//  - DropNewest: the new event is dropped.
+//  - DropOldest: the oldest queued event is evicted to make room.
+//  - Block: the emitting thread waits for room, up to the configured timeout, then drops the event.
+//  - Coalesce: like DropNewest, and a Ready/Update event is not queued while one of the same type is still pending.
+enum class EventOverflowPolicy : std::uint8_t { DropNewest, DropOldest, Block, Coalesce };
+
+// Counters of one event type since the handler was created. Latency is measured from the emit to the callback call.
+struct EventTypeStats {
+    std::uint64_t enqueued = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t coalesced = 0;
+    std::uint64_t dispatched = 0;
+    std::chrono::nanoseconds totalLatency{0};
+    std::chrono::nanoseconds maxLatency{0};
+};
+
+struct EventStats {
+    std::array<EventTypeStats, clientEventCount> byType{};
+
+    const EventTypeStats& operator[](ClientEvent p_type) const {
+        return byType[static_cast<std::size_t>(p_type)];
+    }
+};
+
+// Payloads and callback types of the client events, kept apart from EventHandler so that the client header does not
+// pull in the dispatch machinery.
+struct ClientError final {
+    std::string message;
+    std::string details;
+};
+
+// The context is the client's snapshot at evaluation time, shared by all impressions emitted with it.
+struct ClientImpression final {
+    std::shared_ptr<const Context> ctx;
+    std::string flagName;
+    bool enabled;
+    std::string eventType;
+    bool impressionData;
+    std::string variant = "";
+    // Impressions of this flag dropped by sampling since the previous one was emitted:
+    std::uint64_t suppressed = 0;
+};
+
+// Circuit breaker of the toggle or metrics endpoint: Open skips the calls, HalfOpen lets a single probe through.
+enum class CircuitState : std::uint8_t { Closed, Open, HalfOpen };
+
+struct CircuitStateChange final {
+    // Metrics url, or toggle url(s): with ClientConfig::setUrls(), one breaker covers all of them (a fetch fails once
+    // none answered) and its label lists them, separated by ", ".
+    std::string endpoint;
+    CircuitState from;
+    CircuitState to;
+};
+
+using InitCallback = std::function<void()>;
+using ErrorCallback = std::function<void(const ClientError&)>;
+using ReadyCallback = std::function<void()>;
+using UpdateCallback = std::function<void()>;
+using ImpressionCallback = std::function<void(const ClientImpression&)>;
+using CircuitStateCallback = std::function<void(const CircuitStateChange&)>;
+// Identifies a listener added with one of the addXListener() methods (0: none).
+using ListenerToken = std::uint64_t;
+
+using ImpressionBatchCallback = std::function<void(const std::vector<ClientImpression>&)>;
+
+} // namespace unleash
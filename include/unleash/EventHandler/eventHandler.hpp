@@ -5,84 +5,187 @@
 #include <string>
 #include <cstdint>
 #include <thread>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
+#include <array>
 #include <atomic>
 
-#include "unleash/Domain/context.hpp"
+#include "unleash/EventHandler/clientEvents.hpp"
+#include "unleash/Utils/utils.hpp"
 
 namespace unleash {
 
-enum class ClientEvent : std::uint8_t { Init, Error, Ready, Update, Impression };
+class EventRing;
+struct EventRecord;
+class IScheduler;
+class TaskGuard;
 
 class EventHandler final {
   public:
-    struct ClientError final {
-        std::string message;
-        std::string details;
-    };
-    struct ClientImpression final {
-        Context ctx;
-        std::string flagName;
-        bool enabled;
-        std::string eventType;
-        bool impressionData;
-        std::string variant = "";
-    };
-
-    using InitCallback = std::function<void()>;
-    using ErrorCallback = std::function<void(const ClientError&)>;
-    using ReadyCallback = std::function<void()>;
-    using UpdateCallback = std::function<void()>;
-    using ImpressionCallback = std::function<void(const ClientImpression&)>;
-
-    EventHandler();
+    using ClientError = unleash::ClientError;
+    using ClientImpression = unleash::ClientImpression;
+
+    using InitCallback = unleash::InitCallback;
+    using ErrorCallback = unleash::ErrorCallback;
+    using ReadyCallback = unleash::ReadyCallback;
+    using UpdateCallback = unleash::UpdateCallback;
+    using ImpressionCallback = unleash::ImpressionCallback;
+    using CircuitStateCallback = unleash::CircuitStateCallback;
+    using ImpressionBatchCallback = unleash::ImpressionBatchCallback;
+
+    // p_capacity is rounded up to a power of two.
+    explicit EventHandler(std::size_t p_capacity = utils::maxEventQueueSize,
+                          EventOverflowPolicy p_policy = EventOverflowPolicy::DropNewest,
+                          utils::mSeconds p_blockTimeout = utils::eventBlockTimeout,
+                          std::shared_ptr<IScheduler> p_scheduler = nullptr);
     ~EventHandler();
 
     EventHandler(const EventHandler&) = delete;
     EventHandler& operator=(const EventHandler&) = delete;
 
-    // Start/stop the event dispatch thread
+    // Start/stop the event dispatch thread. With a scheduler, callbacks run in tasks posted to it instead.
     void start();
     void stop();
 
+    // fork() support: dispatch is paused between two batches and the handler locked across the fork. A started
+    // handler dispatches again in the child, from a new thread (or new drain tasks).
+    void prepareFork();
+    void parentAfterFork();
+    void childAfterFork();
+
     // Callback setters
     void onInit(InitCallback cb);
     void onError(ErrorCallback cb);
     void onReady(ReadyCallback cb);
     void onUpdate(UpdateCallback cb);
     void onImpression(ImpressionCallback cb);
+    void onCircuitStateChange(CircuitStateCallback cb);
+    // Impressions are handed over in batches of at most maxBatch, the first one waiting no longer than maxDelay.
+    void onImpressionBatch(ImpressionBatchCallback cb, std::size_t maxBatch = utils::impressionBatchSize,
+                           utils::mSeconds maxDelay = utils::impressionBatchDelay);
+
+    // Additional listeners, called after the onX() one in registration order. The token unsubscribes them.
+    ListenerToken addInitListener(InitCallback cb);
+    ListenerToken addErrorListener(ErrorCallback cb);
+    ListenerToken addReadyListener(ReadyCallback cb);
+    ListenerToken addUpdateListener(UpdateCallback cb);
+    ListenerToken addImpressionListener(ImpressionCallback cb);
+    ListenerToken addCircuitStateChangeListener(CircuitStateCallback cb);
+    bool removeListener(ListenerToken token);
 
     void emitInit() const;
     void emitError(const ClientError& err) const;
     void emitReady() const;
     void emitUpdate() const;
     void emitImpression(const ClientImpression& event) const;
+    // Whether emitImpression() would queue anything (started, with an impression listener or batch callback), so that
+    // callers can skip building, and sampling, impressions nobody receives.
+    bool wantsImpressions() const noexcept;
+    void emitCircuitStateChange(const CircuitStateChange& change) const;
 
     void clearAll();
 
+    std::size_t capacity() const noexcept;
+    EventOverflowPolicy overflowPolicy() const noexcept;
+    EventStats stats() const;
+
   private:
     // event dispatch thread routine
     void eventLoop();
 
-    using EventTask = std::function<void()>;
+    // Scheduler mode: drains the ring in a posted task. _drainScheduled ensures a single drain at a time.
+    void drainTask() const;
+    void scheduleDrain() const;
+
+    void dispatch(EventRecord& record) const;
+
+    // Batched impressions, only touched by the dispatch thread:
+    void appendToImpressionBatch(ClientImpression& impression) const;
+    void flushImpressionBatch() const;
+
+    template <typename Fill> void enqueue(ClientEvent type, Fill&& fill) const;
 
-    mutable std::queue<EventTask> _eventQueue;
-    mutable std::mutex _queueMutex;
-    mutable std::condition_variable _queueCV;
+    template <typename Fill> bool pushBlocking(Fill& fill) const;
+
+    void countDropped(ClientEvent type) const;
+
+    // Wakes the dispatch thread if it is parked:
+    void wakeConsumer() const;
+
+    struct Counters {
+        std::atomic<std::uint64_t> enqueued{0};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> coalesced{0};
+        std::atomic<std::uint64_t> dispatched{0};
+        std::atomic<std::int64_t> totalLatencyNs{0};
+        std::atomic<std::int64_t> maxLatencyNs{0};
+    };
+
+    EventOverflowPolicy _policy;
+    utils::mSeconds _blockTimeout;
+    mutable std::array<Counters, clientEventCount> _counters;
+    // Coalesce policy: a Ready/Update event is queued and not dispatched yet.
+    mutable std::array<std::atomic<bool>, clientEventCount> _pending{};
+
+    // Preallocated lock-free ring of typed records. The dispatch thread drains it and only parks on _parkCV when it is
+    // empty; producers take _parkMutex only when they find it parked.
+    std::unique_ptr<EventRing> _ring;
+    // Held by the dispatcher while it drains the ring, so that fork() never splits a pop:
+    mutable std::mutex _dispatchMutex;
+    mutable std::mutex _parkMutex;
+    mutable std::condition_variable _parkCV;
+    mutable std::atomic<bool> _sleeping{false};
+    // Block policy: producers waiting for room, woken by the dispatch thread.
+    mutable std::mutex _spaceMutex;
+    mutable std::condition_variable _spaceCV;
+    mutable std::atomic<int> _waitingProducers{0};
+
+    std::shared_ptr<IScheduler> _scheduler;
+    std::unique_ptr<TaskGuard> _taskGuard;
+    mutable std::atomic<bool> _drainScheduled{false};
+    mutable std::atomic<bool> _batchTimerArmed{false};
 
     // Event dispatch thread
     std::thread _eventThread;
     std::atomic<bool> _started{false};
     std::atomic<bool> _running{false};
 
-    // Callback storage:
-    mutable std::shared_ptr<InitCallback> _initCb;
-    mutable std::shared_ptr<ErrorCallback> _errorCb;
-    mutable std::shared_ptr<ReadyCallback> _readyCb;
-    mutable std::shared_ptr<UpdateCallback> _updateCb;
-    mutable std::shared_ptr<ImpressionCallback> _impressionCb;
+    // Callback storage: copy-on-write lists, replaced as a whole under _registrationMutex and read by the dispatcher
+    // without locking. primary is the token of the onX() callback, kept first.
+    template <typename Callback> struct ListenerList {
+        using Entries = std::vector<std::pair<ListenerToken, Callback>>;
+        std::shared_ptr<const Entries> entries = std::make_shared<const Entries>();
+        ListenerToken primary = 0;
+    };
+
+    template <typename Callback>
+    ListenerToken addListener(ListenerList<Callback>& list, ClientEvent type, Callback cb, bool primary);
+    template <typename Callback> bool removeFrom(ListenerList<Callback>& list, ClientEvent type, ListenerToken token);
+    template <typename Callback> void clearList(ListenerList<Callback>& list, ClientEvent type);
+    template <typename Callback, typename... Args>
+    void invokeAll(const ListenerList<Callback>& list, const Args&... args) const;
+    bool hasListeners(ClientEvent type) const;
+
+    ListenerList<InitCallback> _initListeners;
+    ListenerList<ErrorCallback> _errorListeners;
+    ListenerList<ReadyCallback> _readyListeners;
+    ListenerList<UpdateCallback> _updateListeners;
+    ListenerList<ImpressionCallback> _impressionListeners;
+    ListenerList<CircuitStateCallback> _circuitListeners;
+    std::mutex _registrationMutex;
+    ListenerToken _nextToken{1};
+    // Listeners per event type (the impression batch callback included), read by the emitters:
+    std::array<std::atomic<std::uint32_t>, clientEventCount> _listenerCounts{};
+
+    struct ImpressionBatchSettings {
+        ImpressionBatchCallback callback;
+        std::size_t maxBatch;
+        utils::mSeconds maxDelay;
+    };
+    mutable std::shared_ptr<ImpressionBatchSettings> _impressionBatchCb;
+    mutable std::vector<ClientImpression> _impressionBatch;
+    mutable std::chrono::steady_clock::time_point _impressionBatchDeadline;
 };
 
 } // namespace unleash
@@ -0,0 +1,57 @@
+#pragma once
+#include "unleash/Utils/utils.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace unleash {
+
+// Chooses the endpoint of the next request among the configured ones. Each endpoint keeps an EWMA of its latency and
+// of its error rate; the healthy endpoint with the lowest expected time (latency / success rate) wins, endpoints
+// never measured are tried first. A failure makes an endpoint unhealthy for a cooldown that doubles with consecutive
+// failures. Not thread-safe: it belongs to the fetcher using it.
+class EndpointSelector {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::string url;
+        double latencyMs = 0.0;
+        double errorRate = 0.0;
+        bool measured = false;
+        std::uint32_t consecutiveFailures = 0;
+        Clock::time_point retryAt{};
+    };
+
+    // Weight of the newest sample in the moving averages.
+    static constexpr double smoothing = 0.3;
+
+    explicit EndpointSelector(const std::vector<std::string>& p_urls,
+                              utils::mSeconds p_retryBase = utils::endpointRetryBase,
+                              utils::mSeconds p_retryMax = utils::endpointRetryMax);
+
+    std::size_t size() const noexcept {
+        return _endpoints.size();
+    }
+
+    const Stats& stats(std::size_t p_index) const {
+        return _endpoints[p_index];
+    }
+
+    // Best endpoint not in p_tried (bit i set: endpoint i already tried), std::nullopt once all were tried.
+    // When none is healthy, the one whose cooldown ends first.
+    std::optional<std::size_t> pick(std::uint64_t p_tried = 0, Clock::time_point p_now = Clock::now()) const;
+
+    void onSuccess(std::size_t p_index, utils::mSeconds p_latency);
+    void onFailure(std::size_t p_index, Clock::time_point p_now = Clock::now());
+
+  private:
+    std::vector<Stats> _endpoints;
+    utils::mSeconds _retryBase;
+    utils::mSeconds _retryMax;
+};
+
+} // namespace unleash
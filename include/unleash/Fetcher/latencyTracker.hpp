@@ -0,0 +1,32 @@
+#pragma once
+#include "unleash/Utils/utils.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace unleash {
+
+// Latencies of the last windowSize requests, for percentile estimates. Not thread-safe.
+class LatencyTracker {
+  public:
+    static constexpr std::size_t windowSize = 128;
+    // Fewer samples than this give no estimate.
+    static constexpr std::size_t minSamples = 8;
+
+    void add(utils::mSeconds p_latency) noexcept;
+
+    std::size_t count() const noexcept {
+        return _count;
+    }
+
+    // p_quantile in (0, 1], e.g. 0.95 for the 95th percentile (nearest rank).
+    std::optional<utils::mSeconds> percentile(double p_quantile) const;
+
+  private:
+    std::array<std::int64_t, windowSize> _samples{};
+    std::size_t _next = 0;
+    std::size_t _count = 0;
+};
+
+} // namespace unleash
@@ -1,12 +1,18 @@
 #pragma once
 #include "unleash/Domain/toggleSet.hpp"
 #include "unleash/Configuration/clientConfig.hpp"
+#include "unleash/Fetcher/endpointSelector.hpp"
+#include "unleash/Fetcher/latencyTracker.hpp"
 #include "unleash/Transport/httpClient.hpp"
 #include <memory>
 #include <algorithm>
 #include <cctype>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <optional>
+#include <cstdint>
 
 namespace unleash {
 
@@ -16,23 +22,115 @@ class ToggleFetcher {
         int status = -1;
         std::optional<ToggleSet> toggles = std::nullopt;
         std::optional<std::string> error;
+        // From Retry-After (delay-seconds or HTTP-date) or RateLimit-Reset:
+        std::optional<utils::mSeconds> retryAfter;
+        // Index in ClientConfig::urls() of the endpoint that answered (the last one tried on failure).
+        std::size_t endpoint = 0;
+        // Duration of the request that answered, and whether it was the hedge (see ClientConfig::setFetchHedging()).
+        utils::mSeconds latency{0};
+        bool hedged = false;
     };
 
     ToggleFetcher(const ClientConfig& p_config);
+    ~ToggleFetcher();
 
-    FetchResult fetch(const Context& p_ctx);
+    ToggleFetcher(const ToggleFetcher&) = delete;
+    ToggleFetcher& operator=(const ToggleFetcher&) = delete;
+
+    // p_cancel aborts the transfer once set; interrupt() makes it notice right away. With several endpoints, a
+    // transport error is retried right away on the next best endpoint not yet tried.
+    FetchResult fetch(const Context& p_ctx, IComClient::CancelToken* p_cancel = nullptr);
+
+    void interrupt();
+
+    // Opens the connection to the endpoint of the first fetch ahead of it, see HttpClient::warmUp().
+    bool warmUp(IComClient::CancelToken* p_cancel = nullptr);
+
+    // fork() support, with no fetch in flight: the race state is locked across the fork. The child drops the kept
+    // connections (see HttpClient::abandonConnections()) and the parent's hedge helper thread, started again by the
+    // next hedged fetch.
+    void prepareFork();
+    void parentAfterFork();
+    void childAfterFork();
+
+    // Forget the ETag, e.g. when the response it came with was not applied.
+    void invalidateEtag() {
+        _etag.clear();
+        _httpRequest.headers.erase("if-none-match");
+    }
 
     const HttpRequest& getHttpRequest() const {
         return _httpRequest;
     }
 
+    const EndpointSelector& endpoints() const {
+        return _endpoints;
+    }
+
+    const LatencyTracker& latencies() const {
+        return _latencies;
+    }
+
   private:
     void makeFrontendRequest(const ClientConfig& p_config);
 
+    // Re-encodes the query (GET) or body (POST) only when the context differs from the last fetch.
+    void encodeContext(const Context& p_ctx);
+
+    // Points the request at endpoint p_index (the query is re-encoded by the next encodeContext()).
+    void useEndpoint(std::size_t p_index);
+
+    // p_tried: endpoints already tried by this fetch, which the hedge avoids.
+    FetchResult fetchOnce(const Context& p_ctx, IComClient::CancelToken* p_cancel, std::uint64_t p_tried);
+    // p_origin: the client that received p_resp, which gets its body buffer back.
+    void decodeResponse(std::unique_ptr<IComResponse> p_resp, HttpClient& p_origin, FetchResult& p_result);
+
+    // When to fire the hedge, std::nullopt for no hedge.
+    std::optional<utils::mSeconds> hedgeDelay() const;
+    std::unique_ptr<IComResponse> hedgedRequest(utils::mSeconds p_delay, IComClient::CancelToken* p_cancel,
+                                                std::uint64_t p_tried, FetchResult& p_result);
+    void hedgeLoop();
+    void stopHedgeThread();
+
     HttpClient _httpClient;
     HttpRequest _httpRequest;
+    utils::mSeconds _timeout;
+    EndpointSelector _endpoints;
+    std::size_t _endpointIndex = 0;
     std::string _baseUrl;
     std::string _etag;
+
+    // Encoded request cache: the context it was encoded from, its appName/sessionId/environment part and the
+    // fingerprint of its mutable part.
+    std::optional<Context> _encodedContext;
+    std::string _staticQuery;
+    std::optional<std::uint64_t> _mutableKey;
+
+    // Hedging: the duplicate request runs on its own client, from a helper thread started by the first hedged fetch
+    // and kept until destruction. Both requests get local cancel tokens, which interrupt() sets once the caller's
+    // token is set.
+    enum class RaceWinner { None, Primary, Hedge };
+
+    LatencyTracker _latencies;
+    double _hedgePercentile;
+    utils::mSeconds _hedgeInitialDelay;
+    HttpClient _hedgeClient;
+    HttpRequest _hedgeRequest;
+    std::thread _hedgeThread;
+    std::mutex _raceMutex;
+    std::condition_variable _raceCv;
+    // Race state, guarded by _raceMutex. _raceArmed: a fetch waits for the helper to be done with its race.
+    IComClient::CancelToken* _raceCaller = nullptr;
+    bool _raceArmed = false;
+    bool _hedgeStop = false;
+    bool _primaryDone = false;
+    EndpointSelector::Clock::time_point _hedgeDue{};
+    std::size_t _hedgeIndex = 0;
+    RaceWinner _winner = RaceWinner::None;
+    std::unique_ptr<IComResponse> _hedgeResp;
+    utils::mSeconds _hedgeLatency{0};
+    IComClient::CancelToken _primaryCancel{false};
+    IComClient::CancelToken _hedgeCancel{false};
 };
 
 } // namespace unleash
@@ -15,6 +15,10 @@ class MetricList final {
     const MetricsMap& getList() const;
     void addEnableMetricData(const std::string& p_toggleName, bool p_isYes);
     void addVariantMetricData(const std::string& p_toggleName, bool p_isYes, const std::string& p_variantName);
+    void addCounts(const std::string& p_toggleName, unsigned int p_yesCount, unsigned int p_noCount);
+    void addVariantCount(const std::string& p_toggleName, const std::string& p_variantName, unsigned int p_count);
+
+    bool empty() const;
 
   private:
     MetricsMap _metricList;
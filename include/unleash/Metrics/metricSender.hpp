@@ -16,12 +16,29 @@ class MetricSender final {
 
     MetricSender(const ClientConfig& p_config);
 
-    MetricResult sendMetrics(const std::string& p_metricBody);
+    // p_cancel aborts the transfer once set; a positive p_timeout replaces the configured query timeout.
+    MetricResult sendMetrics(const std::string& p_metricBody, IComClient::CancelToken* p_cancel = nullptr,
+                             utils::mSeconds p_timeout = utils::mSeconds{0});
+
+    void interrupt() {
+        _httpClient.interrupt();
+    }
+
+    // Opens the connection to the metrics endpoint ahead of the first send, see HttpClient::warmUp().
+    bool warmUp(IComClient::CancelToken* p_cancel = nullptr) {
+        return _httpClient.warmUp(_httpRequest, p_cancel);
+    }
+
+    // To be called in the child after fork(), see HttpClient::abandonConnections().
+    void abandonConnections() {
+        _httpClient.abandonConnections();
+    }
 
   private:
     void initializeHttpRequest(const ClientConfig& p_config);
     HttpClient _httpClient;
     HttpRequest _httpRequest;
+    long _timeoutMs = 0;
 };
 
 } // namespace unleash
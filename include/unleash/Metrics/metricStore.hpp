@@ -3,12 +3,15 @@
 #include "unleash/Configuration/clientConfig.hpp"
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <optional>
 
 namespace unleash {
 
+class SharedMetricsSegment;
+
 class MetricsStore final {
   public:
     using clock = std::chrono::system_clock;
@@ -29,6 +32,17 @@ class MetricsStore final {
 
     std::optional<std::string> toJsonMetricsPayload() const;
 
+    // Encodes the current window and starts a new one, atomically with respect to concurrent evaluations.
+    // With a shared metrics segment, only the elected process gets a payload, aggregated for every process;
+    // p_lease is how long the election holds without renewal.
+    std::optional<std::string> takeJsonMetricsPayload(utils::mSeconds p_lease = utils::mSeconds{0});
+
+    // fork() support: the store is locked across the fork, then the child starts an empty window (and claims its own
+    // slab of a shared segment) so that counts of the parent are not reported twice.
+    void prepareFork();
+    void parentAfterFork();
+    void childAfterFork();
+
   private:
     static std::int64_t nowMs();
 
@@ -38,6 +52,7 @@ class MetricsStore final {
     std::int64_t _startMs = 0;
     std::string _appName;
     std::string _instanceId;
+    std::shared_ptr<SharedMetricsSegment> _shared;
 };
 
 } // namespace unleash
\ No newline at end of file
@@ -8,6 +8,7 @@ namespace unleash {
 class MetricToggle final {
 
   public:
+    explicit MetricToggle(const std::string& p_toggleName);
     explicit MetricToggle(const std::string& p_toggleName, bool p_isYes);
     explicit MetricToggle(const std::string& p_toggleName, bool p_isYes, const std::string& p_variantName);
 
@@ -19,6 +20,10 @@ class MetricToggle final {
     void updateEnableMetric(bool p_isYes);
     void updateVariantMetric(bool p_isYes, const std::string& p_variantName);
 
+    // Bulk updates, used when merging counters aggregated elsewhere:
+    void addCounts(unsigned int p_yesCount, unsigned int p_noCount);
+    void addVariantCount(const std::string& p_variantName, unsigned int p_count);
+
   private:
     std::string _toggleName;
     std::map<std::string, unsigned int> _variantsStats;
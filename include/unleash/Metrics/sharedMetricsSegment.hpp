@@ -0,0 +1,116 @@
+#pragma once
+#include "unleash/Metrics/metricList.hpp"
+#include "unleash/Utils/utils.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace unleash {
+
+// POSIX shared-memory metrics aggregation for pre-fork servers. Every process owns a slab of counters indexed by
+// flag slot and increments it with relaxed atomics, so evaluations never contend across processes. One elected
+// process (lease-based, re-elected if it dies) drains all slabs into a single MetricList and sends one request per
+// host and interval.
+//
+// Not available on Windows: attach() returns nullptr.
+class SharedMetricsSegment final {
+  public:
+    static constexpr std::size_t maxNameLength = 127;
+    static constexpr std::uint32_t defaultMaxWorkers = 64;
+    static constexpr std::uint32_t defaultMaxSlots = 4096;
+
+    // Opens the segment named p_name, creating it if needed, and registers the calling process as a worker.
+    // The sizes are only used by the creator.
+    static std::shared_ptr<SharedMetricsSegment> attach(const std::string& p_name,
+                                                        std::uint32_t p_maxWorkers = defaultMaxWorkers,
+                                                        std::uint32_t p_maxSlots = defaultMaxSlots);
+
+    static bool remove(const std::string& p_name);
+
+    ~SharedMetricsSegment();
+
+    SharedMetricsSegment(const SharedMetricsSegment&) = delete;
+    SharedMetricsSegment& operator=(const SharedMetricsSegment&) = delete;
+
+    // Claims a worker slab for the current process, to be called again in a forked child. Returns false when every
+    // slab is owned by a live process.
+    bool registerWorker();
+
+    // Thread-safe. Once a name has a slot (or is known to have none), recording it is one atomic increment; only the
+    // first evaluation of a name takes a lock.
+    void addEnableMetric(const std::string& p_toggleName, bool p_isYes);
+    void addVariantMetric(const std::string& p_toggleName, bool p_isYes, const std::string& p_variantName);
+
+    // Takes (or renews) the sender lease, valid for p_lease. Only the lease holder should drain and send.
+    bool tryLead(utils::mSeconds p_lease);
+
+    // Moves every worker's counters into a MetricList and starts a new window. p_startMs receives the window start.
+    MetricList drain(std::int64_t& p_startMs);
+
+    // Evaluations not recorded because a name was too long or every slot was taken.
+    std::uint64_t droppedCount() const noexcept;
+
+    // Slots claimed so far by every process, at most the segment's maxSlots.
+    std::uint32_t slotCount() const noexcept;
+
+    // fork() support: the slot cache lock is held across the fork, the child then claims its own slab. Clients sharing
+    // the segment each call the hooks: only the first prepareFork() and the last after-fork call act.
+    void prepareFork();
+    void parentAfterFork();
+    void childAfterFork();
+
+  private:
+    struct Header;
+    struct Slot;
+    struct Counter;
+    struct Layout {
+        std::size_t slotsOffset;
+        std::size_t workersOffset;
+        std::size_t countersOffset;
+        std::size_t slabSize;
+        std::size_t total;
+    };
+
+    static Layout computeLayout(std::uint32_t p_maxWorkers, std::uint32_t p_maxSlots);
+
+    SharedMetricsSegment(void* p_mapping, std::size_t p_mappingSize);
+
+    Slot* slots() const noexcept;
+    std::atomic<std::uint32_t>* workerPids() const noexcept;
+    Counter* counters(std::uint32_t p_worker) const noexcept;
+
+    static constexpr std::uint32_t noSlot = 0xFFFFFFFFu;
+
+    // Local slot cache: toggle name -> slot of its enable counts and slots of its variants. noSlot records a name
+    // that could not get one, so that a full table is not scanned again on every evaluation.
+    struct CachedSlots {
+        std::optional<std::uint32_t> enabled;
+        std::unordered_map<std::string, std::uint32_t> variants;
+    };
+    using SlotCache = std::unordered_map<std::string, CachedSlots>;
+
+    static std::optional<std::uint32_t> cachedSlot(const SlotCache& p_cache, const std::string& p_toggleName,
+                                                   const std::string& p_variantName);
+
+    Counter* counterFor(const std::string& p_toggleName, const std::string& p_variantName);
+    std::uint32_t cacheSlot(const std::string& p_toggleName, const std::string& p_variantName);
+    std::int64_t findOrAllocateSlot(const std::string& p_toggleName, const std::string& p_variantName);
+
+    void* _mapping = nullptr;
+    std::size_t _mappingSize = 0;
+    Header* _header = nullptr;
+    Layout _layout;
+    std::int64_t _worker = -1;
+    // Copy-on-write: evaluations read the current cache without locking, misses copy it under _cacheMutex.
+    std::shared_ptr<const SlotCache> _slotCache;
+    std::mutex _cacheMutex;
+    int _forkHolders = 0; // only touched by the forking thread
+};
+
+} // namespace unleash
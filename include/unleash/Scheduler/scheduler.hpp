@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "unleash/Utils/utils.hpp"
+
+namespace unleash {
+
+// Runs the SDK background work (polling and metrics timers, callback dispatch) on an executor owned by the application,
+// e.g. its event loop or thread pool. Tasks of one client may run on any thread but must not run concurrently with
+// themselves; the SDK never posts a task that blocks for long, besides the HTTP requests of polling and metrics.
+// UnleashClient::stop() waits for the tasks it posted that are running, so it must not be called from one of them.
+class IScheduler {
+  public:
+    using Task = std::function<void()>;
+    using TaskId = std::uint64_t;
+
+    virtual ~IScheduler() = default;
+
+    virtual TaskId post(Task p_task) = 0;
+    virtual TaskId postAfter(utils::mSeconds p_delay, Task p_task) = 0;
+    // True when the task was still pending and will not run.
+    virtual bool cancel(TaskId p_id) = 0;
+};
+
+// IScheduler running every task on one thread of its own, in due time order.
+class ThreadScheduler final : public IScheduler {
+  public:
+    ThreadScheduler();
+    ~ThreadScheduler() override;
+
+    ThreadScheduler(const ThreadScheduler&) = delete;
+    ThreadScheduler& operator=(const ThreadScheduler&) = delete;
+
+    TaskId post(Task p_task) override;
+    TaskId postAfter(utils::mSeconds p_delay, Task p_task) override;
+    bool cancel(TaskId p_id) override;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        Clock::time_point due;
+        TaskId id;
+        bool operator>(const Timer& p_other) const {
+            return due != p_other.due ? due > p_other.due : id > p_other.id;
+        }
+    };
+
+    void run();
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> _timers;
+    std::map<TaskId, Task> _tasks;
+    TaskId _nextId{1};
+    bool _stopping{false};
+    std::thread _thread;
+};
+
+} // namespace unleash
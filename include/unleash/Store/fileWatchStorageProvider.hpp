@@ -0,0 +1,64 @@
+#pragma once
+#include "unleash/Store/storageProvider.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace unleash {
+
+// Read side of a snapshot file maintained by another process (typically one poller per host or a sidecar using a
+// FileStorageProvider with the same appName/backupPath). Once watched, every time the backup file is replaced the new
+// toggles are decoded and pushed to the client, which can then run without polling threads.
+//
+// On Linux the backup directory is watched with inotify; on other platforms the file modification time is polled
+// every utils::fileWatchPollInterval. Snapshots written by save() itself (a client that also polls) are not pushed
+// back: the file content is compared with the last one saved.
+class FileWatchStorageProvider final : public FileStorageProvider {
+  public:
+    explicit FileWatchStorageProvider(std::string appName);
+
+    FileWatchStorageProvider(std::string appName, std::string backupPath);
+
+    ~FileWatchStorageProvider() override;
+
+    FileWatchStorageProvider(const FileWatchStorageProvider&) = delete;
+    FileWatchStorageProvider& operator=(const FileWatchStorageProvider&) = delete;
+
+    void save(const ToggleSet& t) override;
+
+    bool watch(ChangeCallback cb) override;
+
+    void unwatch() override;
+
+    void prepareFork() override;
+    void parentAfterFork() override;
+    void childAfterFork() override;
+
+  private:
+    void watchLoop();
+
+    void reload();
+
+    ChangeCallback _onChange;
+    // Held by reload() while it delivers a snapshot:
+    std::mutex _reloadMutex;
+    int _forkHolders = 0; // clients between prepareFork() and the after-fork hook, only touched by the forking thread
+
+    // Content of the last save(), guarded by _savedMutex:
+    std::mutex _savedMutex;
+    std::string _savedContent;
+
+    std::thread _watchThread;
+    std::atomic_bool _watching{false};
+
+    // Used to interrupt the watch thread on unwatch():
+    std::mutex _stopMutex;
+    std::condition_variable _stopCV;
+    int _inotifyFd = -1;
+    int _wakeFd = -1;
+};
+
+} // namespace unleash
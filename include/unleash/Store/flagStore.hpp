@@ -1,12 +1,16 @@
 #pragma once
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 namespace unleash {
 
 class ToggleSet;
 class Toggle;
+class SharedToggleSegment;
 
 class FlagStore final {
 
@@ -19,9 +23,29 @@ class FlagStore final {
 
     bool isReady() const noexcept;
 
+    // Makes the store follow a segment published by another process, through refresh(): snapshot() and isReady()
+    // never decode, so that evaluations do not either. p_onRefresh runs on the refreshing thread after each swap. Must
+    // be called before the store is shared between threads.
+    void attach(std::shared_ptr<const SharedToggleSegment> p_segment, std::function<void()> p_onRefresh = {});
+
+    // Picks up the latest generation of the attached segment, running p_onRefresh if it swapped the snapshot: one
+    // atomic load when nothing changed. No-op without a segment.
+    void refresh() const noexcept;
+
+    // fork() support: no segment decode is in progress across the fork, same on both sides afterwards.
+    void prepareFork();
+    void afterFork();
+
   private:
+    void refreshFromSegment() const noexcept;
+
     mutable std::shared_ptr<const ToggleSet> _snapshot;
-    std::atomic_bool _ready;
+    mutable std::atomic_bool _ready;
+
+    std::shared_ptr<const SharedToggleSegment> _segment;
+    std::function<void()> _onRefresh;
+    mutable std::atomic<std::uint64_t> _segmentGeneration{0};
+    mutable std::mutex _refreshMutex;
 };
 
-} // namespace unleash
\ No newline at end of file
+} // namespace unleash
@@ -0,0 +1,70 @@
+#pragma once
+#include "unleash/Domain/toggleSet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace unleash {
+
+// POSIX shared-memory segment holding the latest toggle snapshot of a host, for pre-fork servers where one designated
+// process polls Unleash and every other process reads what it publishes.
+//
+// The segment holds two buffers: the publisher always writes the inactive one and then flips the active index.
+// Each buffer is protected by a sequence counter (seqlock), so readers never take a lock nor issue a syscall:
+// checking for a new snapshot is a single atomic load of generation().
+//
+// Not available on Windows: create()/open() return nullptr.
+class SharedToggleSegment final {
+  public:
+    struct Snapshot {
+        ToggleSet toggles;
+        std::uint64_t generation = 0;
+    };
+
+    // Creates (or reuses) the segment named p_name and returns its publisher handle. p_capacityBytes bounds the size of
+    // one encoded snapshot, the segment takes twice that amount plus a small header.
+    static std::shared_ptr<SharedToggleSegment> create(const std::string& p_name, std::size_t p_capacityBytes);
+
+    // Maps an existing segment read-only. Returns nullptr if it does not exist (yet) or is not a toggle segment.
+    static std::shared_ptr<SharedToggleSegment> open(const std::string& p_name);
+
+    // Removes the segment name; processes having it mapped keep working on their mapping.
+    static bool remove(const std::string& p_name);
+
+    ~SharedToggleSegment();
+
+    SharedToggleSegment(const SharedToggleSegment&) = delete;
+    SharedToggleSegment& operator=(const SharedToggleSegment&) = delete;
+
+    bool isPublisher() const noexcept;
+
+    std::size_t capacity() const noexcept;
+
+    // Number of snapshots published so far, 0 while the segment is empty.
+    std::uint64_t generation() const noexcept;
+
+    // Publisher only. Returns false if the encoded snapshot does not fit in capacity().
+    bool publish(const ToggleSet& p_toggles);
+
+    // Latest published snapshot, or nullopt while the segment is empty.
+    std::optional<Snapshot> read() const;
+
+  private:
+    struct Header;
+
+    SharedToggleSegment(void* p_mapping, std::size_t p_mappingSize, bool p_publisher);
+
+    char* buffer(std::uint32_t p_index) const noexcept;
+
+    void* _mapping = nullptr;
+    std::size_t _mappingSize = 0;
+    Header* _header = nullptr;
+    bool _publisher = false;
+    std::mutex _publishMutex;
+};
+
+} // namespace unleash
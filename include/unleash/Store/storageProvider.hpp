@@ -1,13 +1,32 @@
 #pragma once
 #include "unleash/Domain/toggleSet.hpp"
+#include <functional>
+#include <optional>
+#include <string>
 
 namespace unleash {
 
 class IStorageProvider {
   public:
+    using ChangeCallback = std::function<void(ToggleSet)>;
+
     virtual ~IStorageProvider() = default;
     virtual const std::optional<ToggleSet> get() = 0;
     virtual void save(const ToggleSet& t) = 0;
+
+    // Providers fed by an external writer (another process, a sidecar...) can push new snapshots to the client.
+    // Returns false when the provider has no change notification, which is the default.
+    virtual bool watch(ChangeCallback) {
+        return false;
+    }
+    virtual void unwatch() {}
+
+    // fork() support for watching providers (POSIX), called by every client around fork(): prepareFork() holds off
+    // the delivery of snapshots across it, childAfterFork() watches again, the parent's watch being gone there. A
+    // provider shared by several clients gets one call per client.
+    virtual void prepareFork() {}
+    virtual void parentAfterFork() {}
+    virtual void childAfterFork() {}
 };
 
 class LocalStorageProvider final : public IStorageProvider {
@@ -24,7 +43,7 @@ class LocalStorageProvider final : public IStorageProvider {
     std::optional<ToggleSet> empty_{};
 };
 
-class FileStorageProvider final : public IStorageProvider {
+class FileStorageProvider : public IStorageProvider {
   public:
     explicit FileStorageProvider(std::string appName);
 
@@ -32,8 +51,18 @@ class FileStorageProvider final : public IStorageProvider {
 
     const std::optional<ToggleSet> get() override;
 
+    // The backup is written to a temporary file then renamed over the previous one, so readers never observe a
+    // partially written snapshot.
     void save(const ToggleSet& t) override;
 
+    const std::string& filePath() const;
+
+  protected:
+    // Raw content of the backup file, std::nullopt when missing or blank.
+    std::optional<std::string> readContent() const;
+    // Atomic replace (see save()).
+    void writeContent(const std::string& p_content);
+
   private:
     static std::string safeName(std::string s);
 
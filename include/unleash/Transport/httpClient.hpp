@@ -18,9 +18,13 @@ struct HttpRequest : public IComRequest {
     std::map<std::string, std::string> headers;
     std::string body;
     long timeoutMs = 0;
+    // Non-empty: connect through this unix domain socket instead of TCP; the url still gives the Host and path.
+    std::string unixSocketPath;
 };
 
 struct HttpResponse : public IComResponse {
+    // Lowercase keys; only the headers the SDK consumes: etag, content-length, retry-after, ratelimit-reset,
+    // content-encoding.
     std::map<std::string, std::string> headers;
     std::string errorMessage;
 };
@@ -36,44 +40,63 @@ class HttpClient : public IComClient {
     HttpClient& operator=(HttpClient&&) = delete;
 
     std::unique_ptr<IComResponse> request(const IComRequest& req, CancelToken* cancel = nullptr) override;
+    void interrupt() override;
+
+    // fork() child: the inherited handles hold the parent's connections. They are dropped without cleanup (which
+    // would shut down TLS sessions the parent still uses) and replaced by fresh ones.
+    void abandonConnections();
+
+    // Resolves and connects to p_req's endpoint ahead of the first request: a HEAD request on the long-lived handle,
+    // whose DNS entry and kept-alive connection (TLS session included) the next requests reuse. Returns whether the
+    // server answered, whatever the status.
+    bool warmUp(const HttpRequest& p_req, CancelToken* p_cancel = nullptr);
+
+    // Hands a consumed response body back: its capacity is reused by the next response instead of regrowing.
+    void recycleBody(std::string&& p_body);
 
   private:
-    struct CurlSList {
+    // Header list kept between requests: rebuilt only when the headers change, except if-none-match (the ETag of
+    // conditional polls), which is a separate trailing node swapped on its own.
+    struct PreparedHeaders {
+        std::map<std::string, std::string> headers; // without if-none-match
         curl_slist* list = nullptr;
-        ~CurlSList() {
-            if (list)
-                curl_slist_free_all(list);
-        }
-        void append(const char* str) {
-            list = curl_slist_append(list, str);
-        }
-        operator curl_slist*() {
-            return list;
-        }
-    };
+        curl_slist* tail = nullptr;
+        std::string etag;
+        curl_slist* etagNode = nullptr;
 
-    struct CurlHandle {
-        CURL* curl;
-        explicit CurlHandle() : curl(curl_easy_init()) {}
-        ~CurlHandle() {
-            if (curl)
-                curl_easy_cleanup(curl);
-        }
-        operator CURL*() const {
-            return curl;
-        }
-        bool valid() const {
-            return curl != nullptr;
-        }
+        PreparedHeaders() = default;
+        PreparedHeaders(const PreparedHeaders&) = delete;
+        PreparedHeaders& operator=(const PreparedHeaders&) = delete;
+        ~PreparedHeaders();
+
+        // Returns the list to pass as CURLOPT_HTTPHEADER (nullptr when there is no header).
+        curl_slist* update(const std::map<std::string, std::string>& p_headers);
+
+      private:
+        bool sameHeaders(const std::map<std::string, std::string>& p_headers) const;
+        void unlinkEtag();
+        void linkEtag();
     };
 
-    void requestHttp(const HttpRequest& p_req, HttpResponse& p_resp, CancelToken* p_cancel = nullptr);
+    CURL* handle();
+
+    // p_headOnly: HEAD instead of the request's method.
+    void requestHttp(const HttpRequest& p_req, HttpResponse& p_resp, CancelToken* p_cancel = nullptr,
+                     bool p_headOnly = false);
+    CURLcode perform(CURL* p_curl, CancelToken* p_cancel);
 
     static size_t writeCb(char* ptr, size_t size, size_t nmemb, void* userdata);
     static size_t headerCb(char* buffer, size_t size, size_t nitems, void* userdata);
     static int xferInfoCb(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t);
 
-    static std::string trimString(const std::string& str, const char* whitespace);
+    // Long-lived easy handle (kept connections, no per-request setup) and its prepared state:
+    CURL* _curl = nullptr;
+    PreparedHeaders _headers;
+    std::string _url;
+    std::string _unixSocketPath;
+    std::string _bodyPool;
+    // Drives cancellable transfers, so that interrupt() can wake the poll instead of waiting for a progress tick.
+    CURLM* _multi = nullptr;
 };
 
 } // namespace unleash
\ No newline at end of file
@@ -18,7 +18,7 @@ struct IComResponse {
 };
 
 struct ErrorResponse final : public IComResponse {
-    ErrorResponse(ComErrorEnum p_code, std::string p_message) : _code(p_code), _message(std::move(p_message)) {
+    ErrorResponse(ComErrorEnum p_code, std::string p_message) : _message(std::move(p_message)), _code(p_code) {
         status = -1; // Indicate error in status
     }
 
@@ -39,4 +39,6 @@ class IComClient {
     using CancelToken = std::atomic<bool>;
     virtual ~IComClient() = default;
     virtual std::unique_ptr<IComResponse> request(const IComRequest& req, CancelToken* cancel = nullptr) = 0;
+    // Wakes an in-flight request so it sees its cancel token right away. May be called from any thread.
+    virtual void interrupt() {}
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <string_view>
 #include <string>
 #include <variant>
+#include <cstddef>
 #include <cstdint>
 #include <chrono>
 #include <ctime>
@@ -32,6 +33,38 @@ using seconds = std::chrono::seconds;
 using mSeconds = std::chrono::milliseconds;
 
 inline constexpr unsigned int maxEventQueueSize = 30;
+// Longest wait of an emit under EventOverflowPolicy::Block:
+inline constexpr mSeconds eventBlockTimeout{10};
+// Defaults of onImpressionBatch:
+inline constexpr std::size_t impressionBatchSize = 256;
+inline constexpr mSeconds impressionBatchDelay{100};
+
+// Default ceiling of the polling backoff after failures:
+inline constexpr seconds pollBackoffMax{300};
+
+// Endpoints of ClientConfig::setUrls(): at most this many, and a failed one is skipped for a cooldown doubling from
+// the base to the max with consecutive failures.
+inline constexpr std::size_t maxEndpoints = 64;
+inline constexpr mSeconds endpointRetryBase{1000};
+inline constexpr mSeconds endpointRetryMax{60000};
+
+// Fallback polling period of FileWatchStorageProvider where inotify is not available:
+inline constexpr mSeconds fileWatchPollInterval{250};
+
+// How often a client reading a SharedToggleSegment checks for a new generation (one atomic load when unchanged):
+inline constexpr mSeconds sharedSegmentPollInterval{100};
+
+// 64-bit FNV-1a; pass the previous result as p_hash to hash several pieces as one.
+inline constexpr std::uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+inline constexpr std::uint64_t fnvPrime = 1099511628211ULL;
+
+constexpr std::uint64_t fnv1a64(std::string_view p_data, std::uint64_t p_hash = fnvOffsetBasis) {
+    for (char c : p_data) {
+        p_hash ^= static_cast<unsigned char>(c);
+        p_hash *= fnvPrime;
+    }
+    return p_hash;
+}
 
 inline std::string keysToLowerCase(std::string p_key) {
     std::transform(p_key.begin(), p_key.end(), p_key.begin(),
@@ -0,0 +1,160 @@
+#include "internal/binaryCodec.hpp"
+
+#include <cstring>
+
+namespace unleash {
+
+namespace {
+
+enum ToggleFlags : std::uint8_t {
+    ToggleEnabled = 1 << 0,
+    ToggleImpressionData = 1 << 1,
+    VariantEnabled = 1 << 2,
+    VariantHasPayload = 1 << 3,
+};
+
+class Writer final {
+  public:
+    explicit Writer(std::vector<char>& out) : _out(out) {}
+
+    template <typename T> void put(T value) {
+        const auto pos = _out.size();
+        _out.resize(pos + sizeof(T));
+        std::memcpy(_out.data() + pos, &value, sizeof(T));
+    }
+
+    void putString(const std::string& s) {
+        put(static_cast<std::uint32_t>(s.size()));
+        _out.insert(_out.end(), s.begin(), s.end());
+    }
+
+  private:
+    std::vector<char>& _out;
+};
+
+class Reader final {
+  public:
+    Reader(const char* data, std::size_t size) : _data(data), _size(size) {}
+
+    template <typename T> bool get(T& value) {
+        if (_size - _pos < sizeof(T))
+            return false;
+        std::memcpy(&value, _data + _pos, sizeof(T));
+        _pos += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& s) {
+        std::uint32_t len = 0;
+        if (!get(len) || _size - _pos < len)
+            return false;
+        s.assign(_data + _pos, len);
+        _pos += len;
+        return true;
+    }
+
+    std::size_t remaining() const {
+        return _size - _pos;
+    }
+
+  private:
+    const char* _data;
+    std::size_t _size;
+    std::size_t _pos = 0;
+};
+
+std::size_t encodedSize(const Toggle& toggle) {
+    std::size_t size = sizeof(std::uint8_t) + 2 * sizeof(std::uint32_t) + toggle.name().size() +
+                       toggle.variant().name().size();
+    const auto& payload = toggle.variant().payload();
+    if (payload.has_value())
+        size += 2 * sizeof(std::uint32_t) + payload->type().size() + payload->value().size();
+    return size;
+}
+
+} // namespace
+
+std::vector<char> BinaryCodec::encodeToggleSet(const ToggleSet& toggleSet) {
+    std::size_t total = 3 * sizeof(std::uint32_t);
+    for (const auto& [name, toggle] : toggleSet.toggles())
+        total += encodedSize(toggle);
+
+    std::vector<char> out;
+    out.reserve(total);
+    Writer w(out);
+
+    w.put(magic);
+    w.put(formatVersion);
+    w.put(static_cast<std::uint32_t>(toggleSet.size()));
+
+    for (const auto& [name, toggle] : toggleSet.toggles()) {
+        const Variant& variant = toggle.variant();
+        const auto& payload = variant.payload();
+
+        std::uint8_t flags = 0;
+        if (toggle.enabled())
+            flags |= ToggleEnabled;
+        if (toggle.impressionData())
+            flags |= ToggleImpressionData;
+        if (variant.enabled())
+            flags |= VariantEnabled;
+        if (payload.has_value())
+            flags |= VariantHasPayload;
+
+        w.put(flags);
+        w.putString(toggle.name());
+        w.putString(variant.name());
+        if (payload.has_value()) {
+            w.putString(payload->type());
+            w.putString(payload->value());
+        }
+    }
+    return out;
+}
+
+internal::Expected<ToggleSet, std::string> BinaryCodec::decodeToggleSet(const char* data, std::size_t size) {
+    Reader r(data, size);
+
+    std::uint32_t headerMagic = 0;
+    std::uint32_t headerVersion = 0;
+    std::uint32_t count = 0;
+    if (!r.get(headerMagic) || headerMagic != magic) {
+        return internal::unexpected(std::string("invalid snapshot magic"));
+    }
+    if (!r.get(headerVersion) || headerVersion != formatVersion) {
+        return internal::unexpected(std::string("unsupported snapshot version"));
+    }
+    // Each entry takes at least 9 bytes, which bounds the count before reserving:
+    if (!r.get(count) || count > r.remaining() / 9) {
+        return internal::unexpected(std::string("invalid toggle count"));
+    }
+
+    std::vector<Toggle> vToggles;
+    vToggles.reserve(count);
+
+    for (std::uint32_t index = 0; index < count; ++index) {
+        std::uint8_t flags = 0;
+        std::string name;
+        std::string variantName;
+        if (!r.get(flags) || !r.getString(name) || !r.getString(variantName)) {
+            return internal::unexpected("truncated toggle at index " + std::to_string(index));
+        }
+
+        std::optional<Variant::Payload> payload;
+        if (flags & VariantHasPayload) {
+            std::string type;
+            std::string value;
+            if (!r.getString(type) || !r.getString(value)) {
+                return internal::unexpected("truncated payload at index " + std::to_string(index));
+            }
+            payload.emplace(std::move(type), std::move(value));
+        }
+
+        vToggles.emplace_back(std::move(name), (flags & ToggleEnabled) != 0, (flags & ToggleImpressionData) != 0,
+                              Variant{std::move(variantName), (flags & VariantEnabled) != 0, std::move(payload)});
+    }
+
+    return ToggleSet(std::move(vToggles));
+}
+
+} // namespace unleash
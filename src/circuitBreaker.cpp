@@ -0,0 +1,69 @@
+#include "internal/circuitBreaker.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace unleash {
+
+CircuitBreaker::CircuitBreaker(std::string p_endpoint, std::size_t p_failureThreshold, utils::mSeconds p_openDuration)
+    : _endpoint(std::move(p_endpoint)), _failureThreshold(p_failureThreshold), _openDuration(p_openDuration) {}
+
+bool CircuitBreaker::tryAcquire(Transition& p_transition, Clock::time_point p_now) {
+    p_transition.reset();
+    switch (_state) {
+    case CircuitState::Closed:
+        return true;
+    case CircuitState::Open:
+        if (p_now < _openUntil)
+            return false;
+        p_transition = moveTo(CircuitState::HalfOpen);
+        _probeInFlight = true;
+        return true;
+    case CircuitState::HalfOpen:
+        if (_probeInFlight)
+            return false;
+        _probeInFlight = true;
+        return true;
+    }
+    return true;
+}
+
+CircuitBreaker::Transition CircuitBreaker::onSuccess() {
+    _failures = 0;
+    _probeInFlight = false;
+    if (_state == CircuitState::Closed)
+        return std::nullopt;
+    return moveTo(CircuitState::Closed);
+}
+
+CircuitBreaker::Transition CircuitBreaker::onFailure(Clock::time_point p_now) {
+    _probeInFlight = false;
+    if (!enabled())
+        return std::nullopt;
+    if (_state == CircuitState::Closed && ++_failures < _failureThreshold)
+        return std::nullopt;
+    _openUntil = p_now + _openDuration;
+    if (_state == CircuitState::Open)
+        return std::nullopt;
+    return moveTo(CircuitState::Open);
+}
+
+void CircuitBreaker::release() noexcept {
+    _probeInFlight = false;
+}
+
+utils::mSeconds CircuitBreaker::remainingOpen(Clock::time_point p_now) const {
+    if (_state != CircuitState::Open || p_now >= _openUntil)
+        return utils::mSeconds{0};
+    return std::chrono::ceil<utils::mSeconds>(_openUntil - p_now);
+}
+
+CircuitBreaker::Transition CircuitBreaker::moveTo(CircuitState p_state) {
+    CircuitStateChange change{_endpoint, _state, p_state};
+    _state = p_state;
+    if (p_state != CircuitState::Closed)
+        _failures = 0;
+    return change;
+}
+
+} // namespace unleash
@@ -12,7 +12,7 @@ const ToggleSet::Map& Bootstrap::getToggles() const {
 }
 
 ClientConfig::ClientConfig(const std::string& p_url, const std::string& p_clientKey, const std::string& p_appName)
-    : _url(p_url), _clientKey(p_clientKey), _appName(p_appName) {
+    : _url(p_url), _urls{p_url}, _clientKey(p_clientKey), _appName(p_appName) {
     if (_appName.empty()) {
         // define a logging strategy here!
         _appName = std::string(utils::defaultAppName);
@@ -26,6 +26,13 @@ ClientConfig& ClientConfig::setInstanceId(const std::string& p_instanceId) {
     return *this;
 }
 
+ClientConfig& ClientConfig::setUrls(std::vector<std::string> p_urls) {
+    _urls = std::move(p_urls);
+    if (!_urls.empty())
+        _url = _urls.front();
+    return *this;
+}
+
 ClientConfig& ClientConfig::setRefreshInterval(utils::seconds s) {
     _refreshInterval = s;
     return *this;
@@ -41,6 +48,16 @@ ClientConfig& ClientConfig::setMetricsIntervalInitial(utils::seconds s) {
     return *this;
 }
 
+ClientConfig& ClientConfig::setPollBackoffMax(utils::seconds s) {
+    _pollBackoffMax = s;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setPollStartupJitter(utils::mSeconds m) {
+    _pollStartupJitter = m;
+    return *this;
+}
+
 ClientConfig& ClientConfig::setBootstrap(Bootstrap b) {
     _bootstrap = std::move(b);
     return *this;
@@ -66,16 +83,84 @@ ClientConfig& ClientConfig::setImpressionDataAll(bool v) {
     return *this;
 }
 
+ClientConfig& ClientConfig::setImpressionSampleRate(double rate) {
+    _impressionSampleRate = rate;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setFlagImpressionSampleRate(const std::string& flagName, double rate) {
+    _flagImpressionSampleRates[flagName] = rate;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setImpressionFirstN(std::size_t n, utils::mSeconds interval) {
+    _impressionFirstN = n;
+    _impressionFirstNInterval = interval;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setImpressionDedupWindow(utils::mSeconds m) {
+    _impressionDedupWindow = m;
+    return *this;
+}
+
 ClientConfig& ClientConfig::setUsePostRequests(bool v) {
     _usePostRequests = v;
     return *this;
 }
 
+ClientConfig& ClientConfig::setContextUpdateDebounce(utils::mSeconds m) {
+    _contextUpdateDebounce = m;
+    return *this;
+}
+
 ClientConfig& ClientConfig::setTimeOutQueryMS(utils::mSeconds m) {
     _timeOutQueryMS = m;
     return *this;
 }
 
+ClientConfig& ClientConfig::setPreconnect(bool v) {
+    _preconnect = v;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setUnixSocketPath(std::string path) {
+    _unixSocketPath = std::move(path);
+    return *this;
+}
+
+ClientConfig& ClientConfig::setFetchHedging(double quantile, utils::mSeconds initialDelay) {
+    _fetchHedgePercentile = quantile;
+    _fetchHedgeInitialDelay = initialDelay;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setMetricsFlushOnStop(utils::mSeconds deadline) {
+    _metricsFlushOnStop = deadline;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setCircuitBreaker(std::size_t failureThreshold, utils::mSeconds openDuration) {
+    _circuitBreakerThreshold = failureThreshold;
+    _circuitBreakerOpenDuration = openDuration;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setEventQueueCapacity(std::size_t capacity) {
+    _eventQueueCapacity = capacity;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setEventOverflowPolicy(EventOverflowPolicy policy) {
+    _eventOverflowPolicy = policy;
+    return *this;
+}
+
+ClientConfig& ClientConfig::setEventBlockTimeout(utils::mSeconds m) {
+    _eventBlockTimeout = m;
+    return *this;
+}
+
 ClientConfig& ClientConfig::setStorageProvider(std::shared_ptr<IStorageProvider> provider) {
     if (provider) {
         _storageProvider = std::move(provider);
@@ -83,10 +168,29 @@ ClientConfig& ClientConfig::setStorageProvider(std::shared_ptr<IStorageProvider>
     return *this;
 }
 
+ClientConfig& ClientConfig::setSharedToggleSegment(std::shared_ptr<SharedToggleSegment> segment) {
+    _sharedToggleSegment = std::move(segment);
+    return *this;
+}
+
+ClientConfig& ClientConfig::setSharedMetricsSegment(std::shared_ptr<SharedMetricsSegment> segment) {
+    _sharedMetricsSegment = std::move(segment);
+    return *this;
+}
+
+ClientConfig& ClientConfig::setScheduler(std::shared_ptr<IScheduler> scheduler) {
+    _scheduler = std::move(scheduler);
+    return *this;
+}
+
 const std::string& ClientConfig::url() const {
     return _url;
 }
 
+const std::vector<std::string>& ClientConfig::urls() const {
+    return _urls;
+}
+
 const std::string& ClientConfig::clientKey() const {
     return _clientKey;
 }
@@ -115,6 +219,14 @@ utils::seconds ClientConfig::metricsIntervalInitial() const {
     return _metricsIntervalInitial;
 }
 
+utils::seconds ClientConfig::pollBackoffMax() const {
+    return _pollBackoffMax;
+}
+
+utils::mSeconds ClientConfig::pollStartupJitter() const {
+    return _pollStartupJitter;
+}
+
 const std::optional<Bootstrap>& ClientConfig::bootstrap() const {
     return _bootstrap;
 }
@@ -135,14 +247,66 @@ bool ClientConfig::impressionDataAll() const {
     return _impressionDataAll;
 }
 
+double ClientConfig::impressionSampleRate() const {
+    return _impressionSampleRate;
+}
+
+const std::unordered_map<std::string, double>& ClientConfig::flagImpressionSampleRates() const {
+    return _flagImpressionSampleRates;
+}
+
+std::size_t ClientConfig::impressionFirstN() const {
+    return _impressionFirstN;
+}
+
+utils::mSeconds ClientConfig::impressionFirstNInterval() const {
+    return _impressionFirstNInterval;
+}
+
+utils::mSeconds ClientConfig::impressionDedupWindow() const {
+    return _impressionDedupWindow;
+}
+
 bool ClientConfig::usePostRequests() const {
     return _usePostRequests;
 }
 
+utils::mSeconds ClientConfig::contextUpdateDebounce() const {
+    return _contextUpdateDebounce;
+}
+
 utils::mSeconds ClientConfig::timeOutQueryMS() const {
     return _timeOutQueryMS;
 }
 
+bool ClientConfig::preconnect() const {
+    return _preconnect;
+}
+
+const std::string& ClientConfig::unixSocketPath() const {
+    return _unixSocketPath;
+}
+
+double ClientConfig::fetchHedgePercentile() const {
+    return _fetchHedgePercentile;
+}
+
+utils::mSeconds ClientConfig::fetchHedgeInitialDelay() const {
+    return _fetchHedgeInitialDelay;
+}
+
+utils::mSeconds ClientConfig::metricsFlushOnStop() const {
+    return _metricsFlushOnStop;
+}
+
+std::size_t ClientConfig::circuitBreakerThreshold() const {
+    return _circuitBreakerThreshold;
+}
+
+utils::mSeconds ClientConfig::circuitBreakerOpenDuration() const {
+    return _circuitBreakerOpenDuration;
+}
+
 bool ClientConfig::isRefreshEnabled() const {
     return (_refreshInterval.count() > 0);
 }
@@ -150,16 +314,56 @@ bool ClientConfig::isMetricsEnabled() const {
     return (_metricsInterval.count() > 0);
 }
 
+std::size_t ClientConfig::eventQueueCapacity() const {
+    return _eventQueueCapacity;
+}
+
+EventOverflowPolicy ClientConfig::eventOverflowPolicy() const {
+    return _eventOverflowPolicy;
+}
+
+utils::mSeconds ClientConfig::eventBlockTimeout() const {
+    return _eventBlockTimeout;
+}
+
 std::shared_ptr<IStorageProvider> ClientConfig::storageProvider() const {
     return _storageProvider;
 }
 
+std::shared_ptr<SharedToggleSegment> ClientConfig::sharedToggleSegment() const {
+    return _sharedToggleSegment;
+}
+
+std::shared_ptr<SharedMetricsSegment> ClientConfig::sharedMetricsSegment() const {
+    return _sharedMetricsSegment;
+}
+
+std::shared_ptr<IScheduler> ClientConfig::scheduler() const {
+    return _scheduler;
+}
+
 bool ClientConfig::isValid() {
     if (_url.empty() || _clientKey.empty() || _refreshInterval.count() < 0 || _metricsInterval.count() < 0 ||
-        _metricsIntervalInitial.count() < 0) {
+        _metricsIntervalInitial.count() < 0 || _eventQueueCapacity == 0 || _eventBlockTimeout.count() < 0 ||
+        _metricsFlushOnStop.count() < 0 || _contextUpdateDebounce.count() < 0 || _pollBackoffMax.count() < 0 ||
+        _pollStartupJitter.count() < 0 || _circuitBreakerOpenDuration.count() < 0 || _urls.empty() ||
+        _urls.size() > utils::maxEndpoints) {
         // define a logging strategy here!
         return false;
     }
+    for (const auto& url : _urls) {
+        if (url.empty())
+            return false;
+    }
+    auto isRate = [](double rate) { return rate >= 0.0 && rate <= 1.0; };
+    if (!isRate(_fetchHedgePercentile) || _fetchHedgeInitialDelay.count() < 0)
+        return false;
+    if (!isRate(_impressionSampleRate) || _impressionFirstNInterval.count() < 0 || _impressionDedupWindow.count() < 0)
+        return false;
+    for (const auto& flagRate : _flagImpressionSampleRates) {
+        if (!isRate(flagRate.second))
+            return false;
+    }
     return true;
 }
 
@@ -61,6 +61,46 @@ const utils::contextProperties& MutableContext::getProperties() const {
     return _properties;
 }
 
+std::uint64_t MutableContext::fingerprint() const {
+    // Each field is tagged and terminated so that moving bytes between fields changes the hash:
+    auto field = [](std::uint64_t hash, char tag, const std::optional<std::string>& value) {
+        const char head[2] = {tag, value.has_value() ? '1' : '0'};
+        hash = utils::fnv1a64(std::string_view(head, sizeof(head)), hash);
+        if (value.has_value())
+            hash = utils::fnv1a64(*value, hash);
+        return utils::fnv1a64(std::string_view("\0", 1), hash);
+    };
+    std::uint64_t hash = utils::fnvOffsetBasis;
+    hash = field(hash, 'u', _userId);
+    hash = field(hash, 'r', _remoteAddress);
+    hash = field(hash, 't', _currentTime);
+
+    // Keys are unique: summing per-property hashes makes the result independent of insertion order.
+    std::uint64_t properties = 0;
+    for (const auto& [k, v] : _properties) {
+        properties += utils::fnv1a64(v, utils::fnv1a64(std::string_view("\0", 1), utils::fnv1a64(k)));
+    }
+    for (int shift = 0; shift < 64; shift += 8) {
+        const char byte = static_cast<char>((properties >> shift) & 0xff);
+        hash = utils::fnv1a64(std::string_view(&byte, 1), hash);
+    }
+    return hash;
+}
+
+bool MutableContext::operator==(const MutableContext& p_other) const {
+    if (_userId != p_other._userId || _remoteAddress != p_other._remoteAddress ||
+        _currentTime != p_other._currentTime || _properties.size() != p_other._properties.size())
+        return false;
+    // Keys are unique: same size and every property found in the other means equal sets.
+    return std::all_of(_properties.begin(), _properties.end(), [&](const auto& kv) {
+        return std::find(p_other._properties.begin(), p_other._properties.end(), kv) != p_other._properties.end();
+    });
+}
+
+bool MutableContext::operator!=(const MutableContext& p_other) const {
+    return !(*this == p_other);
+}
+
 Context::Context(const std::string& p_appName, const std::string& p_environment, const std::string& p_sessionId)
     : _appName(p_appName), _sessionId(p_sessionId) {
     if (_appName.empty()) {
@@ -81,26 +121,30 @@ const std::string& Context::getSessionId() const {
     return _sessionId;
 }
 
-const std::optional<std::string> Context::getEnvironment() const {
+const std::optional<std::string>& Context::getEnvironment() const {
     return _environment;
 }
 
-const std::optional<std::string> Context::getUserId() const {
+const std::optional<std::string>& Context::getUserId() const {
     return _mutableContext.getUserId();
 }
 
-const std::optional<std::string> Context::getRemoteAddress() const {
+const std::optional<std::string>& Context::getRemoteAddress() const {
     return _mutableContext.getRemoteAddress();
 }
 
-const std::optional<std::string> Context::getCurrentTime() const {
+const std::optional<std::string>& Context::getCurrentTime() const {
     return _mutableContext.getCurrentTime();
 }
 
-const utils::contextProperties Context::getProperties() const {
+const utils::contextProperties& Context::getProperties() const {
     return _mutableContext.getProperties();
 }
 
+const MutableContext& Context::getMutableContext() const {
+    return _mutableContext;
+}
+
 Context& Context::setUserId(const std::string& p_userId) {
     _mutableContext.setUserId(p_userId);
     return *this;
@@ -125,6 +169,10 @@ void Context::updateMutableContext(const MutableContext& p_mutableContext) {
     _mutableContext = p_mutableContext;
 }
 
+std::uint64_t Context::fingerprint() const {
+    return _mutableContext.fingerprint();
+}
+
 void Context::resolveSessionId() {
     std::random_device rd;
     std::mt19937 gen(rd());
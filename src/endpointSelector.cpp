@@ -0,0 +1,62 @@
+#include "unleash/Fetcher/endpointSelector.hpp"
+
+#include <algorithm>
+
+namespace unleash {
+
+namespace {
+
+// Expected time to a successful answer when failed attempts are retried.
+double expectedCost(const EndpointSelector::Stats& p_stats) {
+    return p_stats.latencyMs / std::max(1.0 - p_stats.errorRate, 0.05);
+}
+
+} // namespace
+
+EndpointSelector::EndpointSelector(const std::vector<std::string>& p_urls, utils::mSeconds p_retryBase,
+                                   utils::mSeconds p_retryMax)
+    : _retryBase(p_retryBase), _retryMax(p_retryMax) {
+    const std::size_t count = std::min(p_urls.size(), utils::maxEndpoints);
+    _endpoints.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        _endpoints.push_back(Stats{p_urls[i]});
+}
+
+std::optional<std::size_t> EndpointSelector::pick(std::uint64_t p_tried, Clock::time_point p_now) const {
+    std::optional<std::size_t> best;
+    std::optional<std::size_t> soonest;
+    for (std::size_t i = 0; i < _endpoints.size(); ++i) {
+        if (p_tried & (std::uint64_t{1} << i))
+            continue;
+        const Stats& candidate = _endpoints[i];
+        if (p_now < candidate.retryAt) {
+            if (!soonest || candidate.retryAt < _endpoints[*soonest].retryAt)
+                soonest = i;
+            continue;
+        }
+        if (!candidate.measured)
+            return i;
+        if (!best || expectedCost(candidate) < expectedCost(_endpoints[*best]))
+            best = i;
+    }
+    return best ? best : soonest;
+}
+
+void EndpointSelector::onSuccess(std::size_t p_index, utils::mSeconds p_latency) {
+    Stats& stats = _endpoints[p_index];
+    const auto latencyMs = static_cast<double>(p_latency.count());
+    stats.latencyMs = stats.measured ? stats.latencyMs + smoothing * (latencyMs - stats.latencyMs) : latencyMs;
+    stats.measured = true;
+    stats.errorRate *= 1.0 - smoothing;
+    stats.consecutiveFailures = 0;
+    stats.retryAt = Clock::time_point{};
+}
+
+void EndpointSelector::onFailure(std::size_t p_index, Clock::time_point p_now) {
+    Stats& stats = _endpoints[p_index];
+    stats.errorRate += smoothing * (1.0 - stats.errorRate);
+    const unsigned shift = std::min<std::uint32_t>(stats.consecutiveFailures++, 16);
+    stats.retryAt = p_now + std::min(_retryMax, _retryBase * (std::int64_t{1} << shift));
+}
+
+} // namespace unleash
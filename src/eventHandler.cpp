@@ -1,11 +1,41 @@
 #include "unleash/EventHandler/eventHandler.hpp"
 #include "unleash/Utils/utils.hpp"
+#include "internal/eventRing.hpp"
+#include "internal/forkSupport.hpp"
+#include "internal/taskGuard.hpp"
+#include "unleash/Scheduler/scheduler.hpp"
+#include <algorithm>
 #include <atomic>
 #include <iostream>
+#include <optional>
+#include <utility>
 
 namespace unleash {
 
-EventHandler::EventHandler() = default;
+namespace {
+
+std::int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+constexpr std::size_t indexOf(ClientEvent p_type) {
+    return static_cast<std::size_t>(p_type);
+}
+
+// Handler whose dispatch thread is the current thread, if any:
+thread_local const EventHandler* currentDispatcher = nullptr;
+
+constexpr bool isCoalescable(ClientEvent p_type) {
+    return p_type == ClientEvent::Ready || p_type == ClientEvent::Update;
+}
+
+} // namespace
+
+EventHandler::EventHandler(std::size_t p_capacity, EventOverflowPolicy p_policy, utils::mSeconds p_blockTimeout,
+                           std::shared_ptr<IScheduler> p_scheduler)
+    : _policy(p_policy), _blockTimeout(p_blockTimeout), _ring(std::make_unique<EventRing>(p_capacity)),
+      _scheduler(std::move(p_scheduler)), _taskGuard(std::make_unique<TaskGuard>()) {}
 
 EventHandler::~EventHandler() {
     stop();
@@ -15,6 +45,14 @@ void EventHandler::start() {
     if (_started.exchange(true)) {
         return;
     }
+    if (_scheduler) {
+        _taskGuard->open();
+        _drainScheduled.store(false, std::memory_order_release);
+        _batchTimerArmed.store(false, std::memory_order_release);
+        if (!_ring->empty())
+            scheduleDrain();
+        return;
+    }
     _eventThread = std::thread(&EventHandler::eventLoop, this);
 }
 
@@ -24,89 +62,487 @@ void EventHandler::stop() {
     }
 
     {
-        std::lock_guard<std::mutex> lock(_queueMutex);
-        std::queue<EventTask> empty;
-        _eventQueue.swap(empty); // Drop pending tasks:
+        std::lock_guard<std::mutex> lock(_parkMutex);
     }
-
-    _queueCV.notify_all();
+    _parkCV.notify_all();
 
     if (_eventThread.joinable()) {
         _eventThread.join();
     }
+    if (_scheduler) {
+        // No drain task runs past this point; the batch it was holding is still delivered.
+        _taskGuard->close();
+        flushImpressionBatch();
+    }
+
+    // Drop pending events:
+    EventRecord dropped;
+    while (_ring->tryPop(dropped)) {
+        countDropped(dropped.type);
+    }
+}
+
+void EventHandler::prepareFork() {
+    _dispatchMutex.lock();
+    _registrationMutex.lock();
+    _parkMutex.lock();
+    _spaceMutex.lock();
+    _taskGuard->prepareFork();
+}
+
+void EventHandler::parentAfterFork() {
+    _taskGuard->parentAfterFork();
+    _spaceMutex.unlock();
+    _parkMutex.unlock();
+    _registrationMutex.unlock();
+    _dispatchMutex.unlock();
+}
+
+void EventHandler::childAfterFork() {
+    // Drain tasks, the dispatch thread and the producers waiting for room all belong to the parent:
+    _taskGuard->childAfterFork();
+    _waitingProducers.store(0, std::memory_order_relaxed);
+    _sleeping.store(false, std::memory_order_relaxed);
+    _spaceMutex.unlock();
+    _parkMutex.unlock();
+    _registrationMutex.unlock();
+    _dispatchMutex.unlock();
+    if (!_started.load(std::memory_order_acquire))
+        return;
+    if (_scheduler) {
+        _drainScheduled.store(false, std::memory_order_release);
+        _batchTimerArmed.store(false, std::memory_order_release);
+        if (!_ring->empty())
+            scheduleDrain();
+        return;
+    }
+    forgetThread(_eventThread);
+    _eventThread = std::thread(&EventHandler::eventLoop, this);
+}
+
+std::size_t EventHandler::capacity() const noexcept {
+    return _ring->capacity();
+}
+
+EventOverflowPolicy EventHandler::overflowPolicy() const noexcept {
+    return _policy;
+}
+
+EventStats EventHandler::stats() const {
+    EventStats stats;
+    for (std::size_t i = 0; i < clientEventCount; ++i) {
+        const auto& c = _counters[i];
+        auto& out = stats.byType[i];
+        out.enqueued = c.enqueued.load(std::memory_order_relaxed);
+        out.dropped = c.dropped.load(std::memory_order_relaxed);
+        out.coalesced = c.coalesced.load(std::memory_order_relaxed);
+        out.dispatched = c.dispatched.load(std::memory_order_relaxed);
+        out.totalLatency = std::chrono::nanoseconds(c.totalLatencyNs.load(std::memory_order_relaxed));
+        out.maxLatency = std::chrono::nanoseconds(c.maxLatencyNs.load(std::memory_order_relaxed));
+    }
+    return stats;
 }
 
 void EventHandler::eventLoop() {
+    currentDispatcher = this;
+    EventRecord record;
     while (_started.load(std::memory_order_acquire)) {
-        std::unique_lock<std::mutex> lock(_queueMutex);
+        {
+            std::lock_guard<std::mutex> dispatching(_dispatchMutex);
+            while (_ring->tryPop(record)) {
+                if (_waitingProducers.load(std::memory_order_acquire) > 0) {
+                    {
+                        std::lock_guard<std::mutex> lock(_spaceMutex);
+                    }
+                    _spaceCV.notify_all();
+                }
+                dispatch(record);
+                if (!_started.load(std::memory_order_acquire))
+                    break;
+            }
+            if (!_impressionBatch.empty() && std::chrono::steady_clock::now() >= _impressionBatchDeadline)
+                flushImpressionBatch();
+        }
 
-        _queueCV.wait(lock, [this] { return !_eventQueue.empty() || !_started.load(std::memory_order_acquire); });
+        std::unique_lock<std::mutex> lock(_parkMutex);
+        _sleeping.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in wakeConsumer(): either the producer sees _sleeping or we see its record.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto wakeUp = [this] { return !_ring->empty() || !_started.load(std::memory_order_acquire); };
+        if (_impressionBatch.empty())
+            _parkCV.wait(lock, wakeUp);
+        else
+            _parkCV.wait_until(lock, _impressionBatchDeadline, wakeUp);
+        _sleeping.store(false, std::memory_order_relaxed);
+    }
+    // Impressions already taken off the queue are still delivered:
+    flushImpressionBatch();
+}
 
-        while (!_eventQueue.empty()) {
-            auto task = std::move(_eventQueue.front());
-            _eventQueue.pop();
-            lock.unlock();
+void EventHandler::scheduleDrain() const {
+    if (!_drainScheduled.exchange(true, std::memory_order_acq_rel))
+        _scheduler->post(_taskGuard->wrap([this] { drainTask(); }));
+}
 
-            try {
-                task();
-            } catch (const std::exception& e) {
-                std::cerr << "EventHandler: Exception in callback: " << e.what() << '\n';
-            } catch (...) {
-                std::cerr << "EventHandler: Unknown exception in callback\n";
+void EventHandler::drainTask() const {
+    const EventHandler* previousDispatcher = std::exchange(currentDispatcher, this);
+    EventRecord record;
+    std::optional<std::chrono::steady_clock::time_point> batchDeadline;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> dispatching(_dispatchMutex);
+            while (_started.load(std::memory_order_acquire) && _ring->tryPop(record)) {
+                if (_waitingProducers.load(std::memory_order_acquire) > 0) {
+                    {
+                        std::lock_guard<std::mutex> lock(_spaceMutex);
+                    }
+                    _spaceCV.notify_all();
+                }
+                dispatch(record);
             }
+            if (!_impressionBatch.empty() && std::chrono::steady_clock::now() >= _impressionBatchDeadline)
+                flushImpressionBatch();
+            batchDeadline.reset();
+            if (!_impressionBatch.empty())
+                batchDeadline = _impressionBatchDeadline;
+        }
+
+        _drainScheduled.store(false, std::memory_order_relaxed);
+        // Pairs with the fence in wakeConsumer(): either the producer schedules a drain or we see its record.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_started.load(std::memory_order_acquire) || _ring->empty() ||
+            _drainScheduled.exchange(true, std::memory_order_acq_rel))
+            break;
+    }
+    currentDispatcher = previousDispatcher;
+
+    if (batchDeadline && !_batchTimerArmed.exchange(true, std::memory_order_acq_rel)) {
+        const auto delay = std::chrono::ceil<utils::mSeconds>(*batchDeadline - std::chrono::steady_clock::now());
+        _scheduler->postAfter(std::max(delay, utils::mSeconds{0}), _taskGuard->wrap([this] {
+            _batchTimerArmed.store(false, std::memory_order_release);
+            if (!_drainScheduled.exchange(true, std::memory_order_acq_rel))
+                drainTask();
+        }));
+    }
+}
 
-            lock.lock();
+void EventHandler::wakeConsumer() const {
+    if (_scheduler) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_drainScheduled.load(std::memory_order_relaxed))
+            scheduleDrain();
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(_parkMutex);
         }
+        _parkCV.notify_one();
     }
 }
 
+template <typename Fill> void EventHandler::enqueue(ClientEvent type, Fill&& fill) const {
+    auto& counters = _counters[indexOf(type)];
+    const bool coalesce = _policy == EventOverflowPolicy::Coalesce && isCoalescable(type);
+    if (coalesce && _pending[indexOf(type)].exchange(true, std::memory_order_acq_rel)) {
+        counters.coalesced.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const std::int64_t now = steadyNowNs();
+    auto stampedFill = [&](EventRecord& r) {
+        r.type = type;
+        r.enqueuedNs = now;
+        fill(r);
+    };
+
+    bool pushed = _ring->tryPush(stampedFill);
+    if (!pushed && _policy == EventOverflowPolicy::DropOldest) {
+        EventRecord evicted;
+        for (int attempt = 0; !pushed && attempt < 4; ++attempt) {
+            if (_ring->tryPop(evicted))
+                countDropped(evicted.type);
+            pushed = _ring->tryPush(stampedFill);
+        }
+    } else if (!pushed && _policy == EventOverflowPolicy::Block) {
+        pushed = pushBlocking(stampedFill);
+    }
+
+    if (!pushed) {
+        counters.dropped.fetch_add(1, std::memory_order_relaxed);
+        if (coalesce)
+            _pending[indexOf(type)].store(false, std::memory_order_release);
+        return;
+    }
+    counters.enqueued.fetch_add(1, std::memory_order_relaxed);
+    wakeConsumer();
+}
+
+template <typename Fill> bool EventHandler::pushBlocking(Fill& fill) const {
+    // Emitting from a callback would wait on the dispatch thread itself: the timeout bounds it.
+    if (currentDispatcher == this)
+        return false;
+
+    const auto deadline = std::chrono::steady_clock::now() + _blockTimeout;
+    _waitingProducers.fetch_add(1, std::memory_order_acq_rel);
+    bool pushed = false;
+    while (!pushed && _started.load(std::memory_order_acquire)) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+        {
+            // Short slices so that a wake-up racing with the wait only costs one slice:
+            std::unique_lock<std::mutex> lock(_spaceMutex);
+            _spaceCV.wait_for(lock, std::min<std::chrono::steady_clock::duration>(deadline - now, utils::mSeconds{1}));
+        }
+        pushed = _ring->tryPush(fill);
+    }
+    _waitingProducers.fetch_sub(1, std::memory_order_acq_rel);
+    return pushed;
+}
+
+void EventHandler::countDropped(ClientEvent type) const {
+    _counters[indexOf(type)].dropped.fetch_add(1, std::memory_order_relaxed);
+    if (_policy == EventOverflowPolicy::Coalesce && isCoalescable(type))
+        _pending[indexOf(type)].store(false, std::memory_order_release);
+}
+
+void EventHandler::appendToImpressionBatch(ClientImpression& impression) const {
+    auto batch = std::atomic_load_explicit(&_impressionBatchCb, std::memory_order_acquire);
+    if (!batch || !batch->callback)
+        return;
+    if (_impressionBatch.empty())
+        _impressionBatchDeadline = std::chrono::steady_clock::now() + batch->maxDelay;
+    _impressionBatch.push_back(std::move(impression));
+    if (_impressionBatch.size() >= batch->maxBatch)
+        flushImpressionBatch();
+}
+
+void EventHandler::flushImpressionBatch() const {
+    if (_impressionBatch.empty())
+        return;
+    auto batch = std::atomic_load_explicit(&_impressionBatchCb, std::memory_order_acquire);
+    try {
+        if (batch && batch->callback)
+            batch->callback(_impressionBatch);
+    } catch (const std::exception& e) {
+        std::cerr << "EventHandler: Exception in callback: " << e.what() << '\n';
+    } catch (...) {
+        std::cerr << "EventHandler: Unknown exception in callback\n";
+    }
+    _impressionBatch.clear();
+}
+
+void EventHandler::dispatch(EventRecord& record) const {
+    auto& counters = _counters[indexOf(record.type)];
+    // Events emitted from now on are new information, they must not be coalesced into this one:
+    if (_policy == EventOverflowPolicy::Coalesce && isCoalescable(record.type))
+        _pending[indexOf(record.type)].store(false, std::memory_order_release);
+
+    const std::int64_t latencyNs = steadyNowNs() - record.enqueuedNs;
+    counters.dispatched.fetch_add(1, std::memory_order_relaxed);
+    counters.totalLatencyNs.fetch_add(latencyNs, std::memory_order_relaxed);
+    if (latencyNs > counters.maxLatencyNs.load(std::memory_order_relaxed)) // single consumer
+        counters.maxLatencyNs.store(latencyNs, std::memory_order_relaxed);
+
+    switch (record.type) {
+    case ClientEvent::Init:
+        invokeAll(_initListeners);
+        break;
+    case ClientEvent::Error:
+        invokeAll(_errorListeners, record.error);
+        break;
+    case ClientEvent::Ready:
+        invokeAll(_readyListeners);
+        break;
+    case ClientEvent::Update:
+        invokeAll(_updateListeners);
+        break;
+    case ClientEvent::Impression:
+        invokeAll(_impressionListeners, record.impression);
+        break;
+    case ClientEvent::CircuitStateChange:
+        invokeAll(_circuitListeners, record.circuit);
+        break;
+    }
+
+    if (record.type == ClientEvent::Impression)
+        appendToImpressionBatch(record.impression);
+}
+
+template <typename Callback, typename... Args>
+void EventHandler::invokeAll(const ListenerList<Callback>& list, const Args&... args) const {
+    const auto entries = std::atomic_load_explicit(&list.entries, std::memory_order_acquire);
+    for (const auto& entry : *entries) {
+        // A throwing listener does not keep the others from being called:
+        try {
+            entry.second(args...);
+        } catch (const std::exception& e) {
+            std::cerr << "EventHandler: Exception in callback: " << e.what() << '\n';
+        } catch (...) {
+            std::cerr << "EventHandler: Unknown exception in callback\n";
+        }
+    }
+}
+
+template <typename Callback>
+ListenerToken EventHandler::addListener(ListenerList<Callback>& list, ClientEvent type, Callback cb, bool primary) {
+    std::lock_guard<std::mutex> lk(_registrationMutex);
+    using Entries = typename ListenerList<Callback>::Entries;
+    auto entries = std::make_shared<Entries>(*list.entries);
+    if (primary && list.primary != 0) {
+        // onX() keeps its single-callback semantics: the previous one is replaced.
+        entries->erase(std::remove_if(entries->begin(), entries->end(),
+                                      [&](const auto& entry) { return entry.first == list.primary; }),
+                       entries->end());
+        _listenerCounts[indexOf(type)].fetch_sub(1, std::memory_order_relaxed);
+        list.primary = 0;
+    }
+    ListenerToken token = 0;
+    if (cb) {
+        token = _nextToken++;
+        if (primary) {
+            entries->insert(entries->begin(), {token, std::move(cb)});
+            list.primary = token;
+        } else {
+            entries->emplace_back(token, std::move(cb));
+        }
+        _listenerCounts[indexOf(type)].fetch_add(1, std::memory_order_relaxed);
+    }
+    std::atomic_store_explicit(&list.entries, std::shared_ptr<const Entries>(std::move(entries)),
+                               std::memory_order_release);
+    return token;
+}
+
+template <typename Callback>
+bool EventHandler::removeFrom(ListenerList<Callback>& list, ClientEvent type, ListenerToken token) {
+    using Entries = typename ListenerList<Callback>::Entries;
+    const auto& current = *list.entries;
+    const auto found =
+        std::find_if(current.begin(), current.end(), [&](const auto& entry) { return entry.first == token; });
+    if (found == current.end())
+        return false;
+    auto entries = std::make_shared<Entries>();
+    entries->reserve(current.size() - 1);
+    for (const auto& entry : current) {
+        if (entry.first != token)
+            entries->push_back(entry);
+    }
+    if (list.primary == token)
+        list.primary = 0;
+    std::atomic_store_explicit(&list.entries, std::shared_ptr<const Entries>(std::move(entries)),
+                               std::memory_order_release);
+    _listenerCounts[indexOf(type)].fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename Callback> void EventHandler::clearList(ListenerList<Callback>& list, ClientEvent type) {
+    using Entries = typename ListenerList<Callback>::Entries;
+    std::atomic_store_explicit(&list.entries, std::make_shared<const Entries>(), std::memory_order_release);
+    list.primary = 0;
+    _listenerCounts[indexOf(type)].store(0, std::memory_order_relaxed);
+}
+
+bool EventHandler::hasListeners(ClientEvent type) const {
+    return _listenerCounts[indexOf(type)].load(std::memory_order_relaxed) > 0;
+}
+
 void EventHandler::onInit(InitCallback cb) {
-    auto ptr = cb ? std::make_shared<InitCallback>(std::move(cb)) : std::shared_ptr<InitCallback>{};
-    std::atomic_store_explicit(&_initCb, ptr, std::memory_order_release);
+    addListener(_initListeners, ClientEvent::Init, std::move(cb), true);
 }
 
 void EventHandler::onError(ErrorCallback cb) {
-    auto ptr = cb ? std::make_shared<ErrorCallback>(std::move(cb)) : std::shared_ptr<ErrorCallback>{};
-    std::atomic_store_explicit(&_errorCb, ptr, std::memory_order_release);
+    addListener(_errorListeners, ClientEvent::Error, std::move(cb), true);
 }
 
 void EventHandler::onReady(ReadyCallback cb) {
-    auto ptr = cb ? std::make_shared<ReadyCallback>(std::move(cb)) : std::shared_ptr<ReadyCallback>{};
-    std::atomic_store_explicit(&_readyCb, ptr, std::memory_order_release);
+    addListener(_readyListeners, ClientEvent::Ready, std::move(cb), true);
 }
 
 void EventHandler::onUpdate(UpdateCallback cb) {
-    auto ptr = cb ? std::make_shared<UpdateCallback>(std::move(cb)) : std::shared_ptr<UpdateCallback>{};
-    std::atomic_store_explicit(&_updateCb, ptr, std::memory_order_release);
+    addListener(_updateListeners, ClientEvent::Update, std::move(cb), true);
 }
 
 void EventHandler::onImpression(ImpressionCallback cb) {
-    auto ptr = cb ? std::make_shared<ImpressionCallback>(std::move(cb)) : std::shared_ptr<ImpressionCallback>{};
-    std::atomic_store_explicit(&_impressionCb, ptr, std::memory_order_release);
+    addListener(_impressionListeners, ClientEvent::Impression, std::move(cb), true);
+}
+
+void EventHandler::onCircuitStateChange(CircuitStateCallback cb) {
+    addListener(_circuitListeners, ClientEvent::CircuitStateChange, std::move(cb), true);
+}
+
+ListenerToken EventHandler::addInitListener(InitCallback cb) {
+    return addListener(_initListeners, ClientEvent::Init, std::move(cb), false);
+}
+
+ListenerToken EventHandler::addErrorListener(ErrorCallback cb) {
+    return addListener(_errorListeners, ClientEvent::Error, std::move(cb), false);
+}
+
+ListenerToken EventHandler::addReadyListener(ReadyCallback cb) {
+    return addListener(_readyListeners, ClientEvent::Ready, std::move(cb), false);
+}
+
+ListenerToken EventHandler::addUpdateListener(UpdateCallback cb) {
+    return addListener(_updateListeners, ClientEvent::Update, std::move(cb), false);
+}
+
+ListenerToken EventHandler::addImpressionListener(ImpressionCallback cb) {
+    return addListener(_impressionListeners, ClientEvent::Impression, std::move(cb), false);
+}
+
+ListenerToken EventHandler::addCircuitStateChangeListener(CircuitStateCallback cb) {
+    return addListener(_circuitListeners, ClientEvent::CircuitStateChange, std::move(cb), false);
+}
+
+bool EventHandler::removeListener(ListenerToken token) {
+    if (token == 0)
+        return false;
+    std::lock_guard<std::mutex> lk(_registrationMutex);
+    return removeFrom(_initListeners, ClientEvent::Init, token) ||
+           removeFrom(_errorListeners, ClientEvent::Error, token) ||
+           removeFrom(_readyListeners, ClientEvent::Ready, token) ||
+           removeFrom(_updateListeners, ClientEvent::Update, token) ||
+           removeFrom(_impressionListeners, ClientEvent::Impression, token) ||
+           removeFrom(_circuitListeners, ClientEvent::CircuitStateChange, token);
+}
+
+void EventHandler::onImpressionBatch(ImpressionBatchCallback cb, std::size_t maxBatch, utils::mSeconds maxDelay) {
+    auto ptr = cb ? std::make_shared<ImpressionBatchSettings>(
+                        ImpressionBatchSettings{std::move(cb), std::max<std::size_t>(maxBatch, 1), maxDelay})
+                  : std::shared_ptr<ImpressionBatchSettings>{};
+    std::lock_guard<std::mutex> lk(_registrationMutex);
+    const bool had = std::atomic_load_explicit(&_impressionBatchCb, std::memory_order_acquire) != nullptr;
+    std::atomic_store_explicit(&_impressionBatchCb, ptr, std::memory_order_release);
+    if (had != (ptr != nullptr)) {
+        if (ptr)
+            _listenerCounts[indexOf(ClientEvent::Impression)].fetch_add(1, std::memory_order_relaxed);
+        else
+            _listenerCounts[indexOf(ClientEvent::Impression)].fetch_sub(1, std::memory_order_relaxed);
+    }
 }
 
 void EventHandler::clearAll() {
-    std::atomic_store_explicit(&_initCb, std::shared_ptr<InitCallback>{}, std::memory_order_release);
-    std::atomic_store_explicit(&_errorCb, std::shared_ptr<ErrorCallback>{}, std::memory_order_release);
-    std::atomic_store_explicit(&_readyCb, std::shared_ptr<ReadyCallback>{}, std::memory_order_release);
-    std::atomic_store_explicit(&_updateCb, std::shared_ptr<UpdateCallback>{}, std::memory_order_release);
-    std::atomic_store_explicit(&_impressionCb, std::shared_ptr<ImpressionCallback>{}, std::memory_order_release);
+    std::lock_guard<std::mutex> lk(_registrationMutex);
+    clearList(_initListeners, ClientEvent::Init);
+    clearList(_errorListeners, ClientEvent::Error);
+    clearList(_readyListeners, ClientEvent::Ready);
+    clearList(_updateListeners, ClientEvent::Update);
+    clearList(_impressionListeners, ClientEvent::Impression);
+    clearList(_circuitListeners, ClientEvent::CircuitStateChange);
+    std::atomic_store_explicit(&_impressionBatchCb, std::shared_ptr<ImpressionBatchSettings>{},
+                               std::memory_order_release);
 }
 
+// Emitters only read the listener counts: no lock and no reference count on the emit path.
 void EventHandler::emitInit() const {
     if (!_started.load(std::memory_order_acquire)) {
         return;
     }
 
-    auto cb = std::atomic_load_explicit(&_initCb, std::memory_order_acquire);
-    if (cb && *cb) {
-        {
-            std::lock_guard<std::mutex> lock(_queueMutex);
-            if (_eventQueue.size() < utils::maxEventQueueSize) {
-                _eventQueue.push([cb]() { (*cb)(); });
-            }
-        }
-        _queueCV.notify_one();
+    if (hasListeners(ClientEvent::Init)) {
+        enqueue(ClientEvent::Init, [](EventRecord&) {});
     }
 }
 
@@ -115,15 +551,8 @@ void EventHandler::emitError(const ClientError& err) const {
         return;
     }
 
-    auto cb = std::atomic_load_explicit(&_errorCb, std::memory_order_acquire);
-    if (cb && *cb) {
-        {
-            std::lock_guard<std::mutex> lock(_queueMutex);
-            if (_eventQueue.size() < utils::maxEventQueueSize) {
-                _eventQueue.push([cb, err]() { (*cb)(err); });
-            }
-        }
-        _queueCV.notify_one();
+    if (hasListeners(ClientEvent::Error)) {
+        enqueue(ClientEvent::Error, [&err](EventRecord& r) { r.error = err; });
     }
 }
 
@@ -132,15 +561,8 @@ void EventHandler::emitReady() const {
         return;
     }
 
-    auto cb = std::atomic_load_explicit(&_readyCb, std::memory_order_acquire);
-    if (cb && *cb) {
-        {
-            std::lock_guard<std::mutex> lock(_queueMutex);
-            if (_eventQueue.size() < utils::maxEventQueueSize) {
-                _eventQueue.push([cb]() { (*cb)(); });
-            }
-        }
-        _queueCV.notify_one();
+    if (hasListeners(ClientEvent::Ready)) {
+        enqueue(ClientEvent::Ready, [](EventRecord&) {});
     }
 }
 
@@ -149,15 +571,8 @@ void EventHandler::emitUpdate() const {
         return;
     }
 
-    auto cb = std::atomic_load_explicit(&_updateCb, std::memory_order_acquire);
-    if (cb && *cb) {
-        {
-            std::lock_guard<std::mutex> lock(_queueMutex);
-            if (_eventQueue.size() < utils::maxEventQueueSize) {
-                _eventQueue.push([cb]() { (*cb)(); });
-            }
-        }
-        _queueCV.notify_one();
+    if (hasListeners(ClientEvent::Update)) {
+        enqueue(ClientEvent::Update, [](EventRecord&) {});
     }
 }
 
@@ -166,16 +581,23 @@ void EventHandler::emitImpression(const ClientImpression& event) const {
         return;
     }
 
-    auto cb = std::atomic_load_explicit(&_impressionCb, std::memory_order_acquire);
-    if (cb && *cb) {
-        {
-            std::lock_guard<std::mutex> lock(_queueMutex);
-            if (_eventQueue.size() < utils::maxEventQueueSize) {
-                _eventQueue.push([cb, event]() { (*cb)(event); });
-            }
-        }
-        _queueCV.notify_one();
+    if (hasListeners(ClientEvent::Impression)) {
+        enqueue(ClientEvent::Impression, [&event](EventRecord& r) { r.impression = event; });
+    }
+}
+
+bool EventHandler::wantsImpressions() const noexcept {
+    return _started.load(std::memory_order_acquire) && hasListeners(ClientEvent::Impression);
+}
+
+void EventHandler::emitCircuitStateChange(const CircuitStateChange& change) const {
+    if (!_started.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (hasListeners(ClientEvent::CircuitStateChange)) {
+        enqueue(ClientEvent::CircuitStateChange, [&change](EventRecord& r) { r.circuit = change; });
     }
 }
 
-} // namespace unleash
\ No newline at end of file
+} // namespace unleash
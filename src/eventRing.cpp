@@ -0,0 +1,58 @@
+#include "internal/eventRing.hpp"
+
+#include <utility>
+
+namespace unleash {
+
+namespace {
+
+std::size_t roundUpToPowerOfTwo(std::size_t p_value) {
+    std::size_t capacity = 2;
+    while (capacity < p_value)
+        capacity <<= 1;
+    return capacity;
+}
+
+} // namespace
+
+EventRing::EventRing(std::size_t p_minCapacity) {
+    const std::size_t capacity = roundUpToPowerOfTwo(p_minCapacity);
+    _cells = std::make_unique<Cell[]>(capacity);
+    _mask = capacity - 1;
+    for (std::size_t i = 0; i < capacity; ++i)
+        _cells[i].seq.store(i, std::memory_order_relaxed);
+}
+
+bool EventRing::tryPop(EventRecord& p_out) {
+    Cell* cell = nullptr;
+    std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &_cells[pos & _mask];
+        const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false; // empty
+        } else {
+            pos = _dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    using std::swap;
+    p_out.type = cell->record.type;
+    p_out.enqueuedNs = cell->record.enqueuedNs;
+    swap(p_out.error, cell->record.error);
+    swap(p_out.impression, cell->record.impression);
+    swap(p_out.circuit, cell->record.circuit);
+    cell->seq.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+bool EventRing::empty() const noexcept {
+    const std::size_t pos = _dequeuePos.load(std::memory_order_acquire);
+    const std::size_t seq = _cells[pos & _mask].seq.load(std::memory_order_acquire);
+    return seq != pos + 1;
+}
+
+} // namespace unleash
@@ -0,0 +1,239 @@
+#include "unleash/Store/fileWatchStorageProvider.hpp"
+#include "internal/forkSupport.hpp"
+#include "internal/jsonCodec.hpp"
+#include "unleash/Utils/utils.hpp"
+
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace unleash {
+
+FileWatchStorageProvider::FileWatchStorageProvider(std::string appName) : FileStorageProvider(std::move(appName)) {}
+
+FileWatchStorageProvider::FileWatchStorageProvider(std::string appName, std::string backupPath)
+    : FileStorageProvider(std::move(appName), std::move(backupPath)) {}
+
+FileWatchStorageProvider::~FileWatchStorageProvider() {
+    unwatch();
+}
+
+void FileWatchStorageProvider::save(const ToggleSet& t) {
+    // Recorded before the write, which the watch thread may see right away:
+    std::string content = JsonCodec::encodeClientFeaturesResponse(t);
+    {
+        std::lock_guard<std::mutex> lk(_savedMutex);
+        _savedContent = content;
+    }
+    writeContent(content);
+}
+
+bool FileWatchStorageProvider::watch(ChangeCallback cb) {
+    if (!cb) {
+        return false;
+    }
+    if (_watching.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    // The directory is watched rather than the file, as an atomic replace swaps the inode behind the path:
+    const std::filesystem::path dir = std::filesystem::path(filePath()).parent_path();
+    std::error_code ec;
+    if (!dir.empty()) {
+        std::filesystem::create_directories(dir, ec);
+        if (ec) {
+            return false;
+        }
+    }
+
+#if defined(__linux__)
+    _inotifyFd = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (_inotifyFd < 0) {
+        return false;
+    }
+    const std::string dirName = dir.empty() ? std::string(".") : dir.string();
+    if (::inotify_add_watch(_inotifyFd, dirName.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        ::close(_inotifyFd);
+        _inotifyFd = -1;
+        return false;
+    }
+    _wakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_wakeFd < 0) {
+        ::close(_inotifyFd);
+        _inotifyFd = -1;
+        return false;
+    }
+#endif
+
+    _onChange = std::move(cb);
+    _watching.store(true, std::memory_order_release);
+    _watchThread = std::thread(&FileWatchStorageProvider::watchLoop, this);
+    return true;
+}
+
+void FileWatchStorageProvider::unwatch() {
+    if (!_watching.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+#if defined(__linux__)
+    const std::uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(_wakeFd, &one, sizeof(one));
+#else
+    {
+        std::lock_guard<std::mutex> lk(_stopMutex);
+    }
+    _stopCV.notify_all();
+#endif
+
+    if (_watchThread.joinable()) {
+        _watchThread.join();
+    }
+
+#if defined(__linux__)
+    ::close(_inotifyFd);
+    ::close(_wakeFd);
+    _inotifyFd = -1;
+    _wakeFd = -1;
+#endif
+    _onChange = nullptr;
+}
+
+void FileWatchStorageProvider::prepareFork() {
+    if (_forkHolders++ > 0) {
+        return;
+    }
+    _reloadMutex.lock();
+    _stopMutex.lock();
+    _savedMutex.lock();
+}
+
+void FileWatchStorageProvider::parentAfterFork() {
+    if (--_forkHolders > 0) {
+        return;
+    }
+    _savedMutex.unlock();
+    _stopMutex.unlock();
+    _reloadMutex.unlock();
+}
+
+void FileWatchStorageProvider::childAfterFork() {
+    if (--_forkHolders > 0) {
+        return;
+    }
+    _savedMutex.unlock();
+    _stopMutex.unlock();
+    _reloadMutex.unlock();
+    if (!_watching.load(std::memory_order_acquire)) {
+        return;
+    }
+    // The watch thread is the parent's, and so are the inherited descriptors: watch again with our own.
+    forgetThread(_watchThread);
+#if defined(__linux__)
+    ::close(_inotifyFd);
+    ::close(_wakeFd);
+    _inotifyFd = -1;
+    _wakeFd = -1;
+#endif
+    _watching.store(false, std::memory_order_release);
+    watch(std::exchange(_onChange, nullptr));
+}
+
+void FileWatchStorageProvider::reload() {
+    std::lock_guard<std::mutex> delivering(_reloadMutex);
+    const auto content = readContent();
+    if (!content.has_value() || !_onChange) {
+        return;
+    }
+    {
+        // Our own snapshot: the client applied it already.
+        std::lock_guard<std::mutex> lk(_savedMutex);
+        if (*content == _savedContent) {
+            return;
+        }
+    }
+    auto toggles = JsonCodec::decodeClientFeaturesResponse(*content);
+    // A missing or partially written file (non-atomic writer) is ignored, the next close/rename will retrigger:
+    if (toggles.has_value()) {
+        _onChange(std::move(toggles.value()));
+    }
+}
+
+#if defined(__linux__)
+
+void FileWatchStorageProvider::watchLoop() {
+    const std::string fileName = std::filesystem::path(filePath()).filename().string();
+    alignas(inotify_event) char buffer[4096];
+
+    while (_watching.load(std::memory_order_acquire)) {
+        pollfd fds[2] = {{_inotifyFd, POLLIN, 0}, {_wakeFd, POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            continue; // EINTR
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        bool changed = false;
+        ssize_t len = 0;
+        while ((len = ::read(_inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0 && fileName == event->name) {
+                    changed = true;
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            reload();
+        }
+    }
+}
+
+#else
+
+void FileWatchStorageProvider::watchLoop() {
+    const std::filesystem::path path(filePath());
+    std::error_code ec;
+    auto lastWrite = std::filesystem::last_write_time(path, ec);
+    bool existed = !ec;
+
+    std::unique_lock<std::mutex> lock(_stopMutex);
+    while (_watching.load(std::memory_order_acquire)) {
+        _stopCV.wait_for(lock, utils::fileWatchPollInterval,
+                         [this] { return !_watching.load(std::memory_order_acquire); });
+        if (!_watching.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        const auto current = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            existed = false;
+            continue;
+        }
+        if (existed && current == lastWrite) {
+            continue;
+        }
+        existed = true;
+        lastWrite = current;
+
+        lock.unlock();
+        reload();
+        lock.lock();
+    }
+}
+
+#endif
+
+} // namespace unleash
@@ -1,6 +1,7 @@
 #include "unleash/Store/flagStore.hpp"
 #include "unleash/Domain/toggleSet.hpp"
 #include "unleash/Domain/toggle.hpp"
+#include "unleash/Store/sharedToggleSegment.hpp"
 
 namespace unleash {
 
@@ -21,4 +22,56 @@ bool FlagStore::isReady() const noexcept {
     return _ready.load(std::memory_order_acquire);
 }
 
+void FlagStore::attach(std::shared_ptr<const SharedToggleSegment> p_segment, std::function<void()> p_onRefresh) {
+    _segment = std::move(p_segment);
+    _onRefresh = std::move(p_onRefresh);
+    _segmentGeneration.store(0, std::memory_order_relaxed);
+}
+
+void FlagStore::refresh() const noexcept {
+    if (_segment)
+        refreshFromSegment();
+}
+
+void FlagStore::prepareFork() {
+    _refreshMutex.lock();
+}
+
+void FlagStore::afterFork() {
+    _refreshMutex.unlock();
+}
+
+void FlagStore::refreshFromSegment() const noexcept {
+    const std::uint64_t generation = _segment->generation();
+    if (generation == _segmentGeneration.load(std::memory_order_acquire))
+        return;
+
+    // Only one thread decodes a new generation, the others keep serving the previous snapshot meanwhile:
+    std::unique_lock<std::mutex> lk(_refreshMutex, std::try_to_lock);
+    if (!lk.owns_lock())
+        return;
+
+    try {
+        auto published = _segment->read();
+        if (!published.has_value()) {
+            // Undecodable generation: do not retry it on every evaluation, wait for the next publish.
+            _segmentGeneration.store(generation, std::memory_order_release);
+            return;
+        }
+        if (published->generation == _segmentGeneration.load(std::memory_order_relaxed))
+            return;
+
+        std::atomic_store(&_snapshot,
+                          std::shared_ptr<const ToggleSet>(std::make_shared<ToggleSet>(std::move(published->toggles))));
+        _ready.store(true, std::memory_order_release);
+        _segmentGeneration.store(published->generation, std::memory_order_release);
+        lk.unlock();
+
+        if (_onRefresh)
+            _onRefresh();
+    } catch (...) {
+        // Out of memory while decoding: keep the current snapshot, the next call retries.
+    }
+}
+
 } // namespace unleash
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <cctype>
 #include <algorithm>
+#include <string_view>
 
 namespace unleash {
 
@@ -20,14 +21,74 @@ void ensureCurlInit() {
     static CurlGlobalInit init;
 }
 
+constexpr std::string_view etagHeader = "if-none-match";
+
+// Upper bound of the reservation made from Content-Length: the header alone does not get to allocate more.
+constexpr curl_off_t maxBodyReserve = 64 * 1024 * 1024;
+
+bool equalsLowercase(std::string_view p_value, std::string_view p_lowercase) {
+    if (p_value.size() != p_lowercase.size())
+        return false;
+    for (std::size_t i = 0; i < p_value.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(p_value[i])) != p_lowercase[i])
+            return false;
+    }
+    return true;
+}
+
+std::string_view trimView(std::string_view p_value) {
+    constexpr std::string_view whitespace = " \t\r\n";
+    const auto start = p_value.find_first_not_of(whitespace);
+    if (start == std::string_view::npos)
+        return {};
+    const auto end = p_value.find_last_not_of(whitespace);
+    return p_value.substr(start, end - start + 1);
+}
+
 } // namespace
 
 HttpClient::HttpClient() {
     ensureCurlInit();
+    _multi = curl_multi_init();
 }
 
 HttpClient::~HttpClient() {
-    // Cleanup handled by singleton
+    // Global cleanup handled by singleton
+    if (_curl)
+        curl_easy_cleanup(_curl);
+    if (_multi)
+        curl_multi_cleanup(_multi);
+}
+
+void HttpClient::recycleBody(std::string&& p_body) {
+    if (p_body.capacity() > _bodyPool.capacity())
+        _bodyPool = std::move(p_body);
+}
+
+void HttpClient::abandonConnections() {
+    _curl = nullptr;
+    _url.clear();
+    _unixSocketPath.clear();
+    _multi = curl_multi_init();
+}
+
+CURL* HttpClient::handle() {
+    if (!_curl) {
+        _curl = curl_easy_init();
+        if (!_curl)
+            return nullptr;
+        // Options that are the same for every request:
+        curl_easy_setopt(_curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, &writeCb);
+        curl_easy_setopt(_curl, CURLOPT_HEADERFUNCTION, &headerCb);
+        curl_easy_setopt(_curl, CURLOPT_XFERINFOFUNCTION, &xferInfoCb);
+    }
+    return _curl;
+}
+
+void HttpClient::interrupt() {
+    if (_multi)
+        curl_multi_wakeup(_multi);
 }
 
 std::unique_ptr<IComResponse> HttpClient::request(const IComRequest& p_req, CancelToken* p_cancel) {
@@ -45,61 +106,67 @@ std::unique_ptr<IComResponse> HttpClient::request(const IComRequest& p_req, Canc
     return httpResp;
 }
 
-void HttpClient::requestHttp(const HttpRequest& p_req, HttpResponse& p_resp, CancelToken* p_cancel) {
-    CurlHandle curlHandle;
-    if (!curlHandle.valid()) {
+bool HttpClient::warmUp(const HttpRequest& p_req, CancelToken* p_cancel) {
+    HttpResponse resp;
+    requestHttp(p_req, resp, p_cancel, true);
+    // The (empty) body came from the pool: hand it back for the first real response.
+    recycleBody(std::move(resp.body));
+    return resp.status > 0;
+}
+
+void HttpClient::requestHttp(const HttpRequest& p_req, HttpResponse& p_resp, CancelToken* p_cancel,
+                             bool p_headOnly) {
+    CURL* curl = handle();
+    if (!curl) {
         p_resp.status = -1;
         p_resp.errorMessage = "Failed to initialize CURL";
         return;
     }
 
-    CURL* curl = curlHandle;
+    // Set URL (libcurl copies it: only when it changes)
+    if (_url != p_req.url) {
+        _url = p_req.url;
+        curl_easy_setopt(curl, CURLOPT_URL, _url.c_str());
+    }
 
-    // Set URL
-    curl_easy_setopt(curl, CURLOPT_URL, p_req.url.c_str());
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    // Set unix domain socket (empty: TCP), likewise only when it changes
+    if (_unixSocketPath != p_req.unixSocketPath) {
+        _unixSocketPath = p_req.unixSocketPath;
+        curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH,
+                         _unixSocketPath.empty() ? nullptr : _unixSocketPath.c_str());
+    }
 
     // Set HTTP method and body
-    if (p_req.usePOSTrequests) {
+    if (p_headOnly) {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (p_req.usePOSTrequests) {
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, p_req.body.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, p_req.body.size());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(p_req.body.size()));
     } else {
         curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
     }
 
-    // Set timeout
-    if (p_req.timeoutMs > 0) {
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, p_req.timeoutMs);
-    }
+    // Set timeout (0: none)
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, p_req.timeoutMs > 0 ? p_req.timeoutMs : 0L);
 
     // Set headers
-    CurlSList hdrs;
-    for (const auto& [k, v] : p_req.headers) {
-        std::string line = k + ": " + v;
-        hdrs.append(line.c_str());
-    }
-    if (hdrs.list) {
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, hdrs.list);
-    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, _headers.update(p_req.headers));
 
-    // Set response body callback
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &writeCb);
+    // Set response body and header destinations; the body starts from the pooled buffer
+    p_resp.body.swap(_bodyPool);
+    p_resp.body.clear();
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &p_resp.body);
-
-    // Set response header callback
-    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &headerCb);
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &p_resp.headers);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &p_resp);
 
     // Set progress callback for cancellation
-    if (p_cancel) {
-        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
-        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, &xferInfoCb);
-        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, p_cancel);
-    }
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, p_cancel ? 0L : 1L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, p_cancel);
 
     // Perform the curl operation
-    CURLcode code = curl_easy_perform(curl);
+    CURLcode code = perform(curl, p_cancel);
+    if (p_headOnly)
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 0L);
 
     if (code == CURLE_OK) {
         long statusCode = 0;
@@ -115,6 +182,106 @@ void HttpClient::requestHttp(const HttpRequest& p_req, HttpResponse& p_resp, Can
     }
 }
 
+HttpClient::PreparedHeaders::~PreparedHeaders() {
+    unlinkEtag();
+    if (etagNode)
+        curl_slist_free_all(etagNode);
+    if (list)
+        curl_slist_free_all(list);
+}
+
+bool HttpClient::PreparedHeaders::sameHeaders(const std::map<std::string, std::string>& p_headers) const {
+    auto it = headers.begin();
+    for (const auto& [k, v] : p_headers) {
+        if (k == etagHeader)
+            continue;
+        if (it == headers.end() || it->first != k || it->second != v)
+            return false;
+        ++it;
+    }
+    return it == headers.end();
+}
+
+void HttpClient::PreparedHeaders::unlinkEtag() {
+    if (tail)
+        tail->next = nullptr;
+}
+
+void HttpClient::PreparedHeaders::linkEtag() {
+    if (tail)
+        tail->next = etagNode;
+}
+
+curl_slist* HttpClient::PreparedHeaders::update(const std::map<std::string, std::string>& p_headers) {
+    if (!sameHeaders(p_headers)) {
+        unlinkEtag();
+        if (list)
+            curl_slist_free_all(list);
+        list = nullptr;
+        tail = nullptr;
+        headers.clear();
+
+        std::string line;
+        for (const auto& [k, v] : p_headers) {
+            if (k == etagHeader)
+                continue;
+            line.assign(k).append(": ").append(v);
+            if (auto* appended = curl_slist_append(list, line.c_str()))
+                list = appended;
+            headers.emplace(k, v);
+        }
+        for (tail = list; tail && tail->next; tail = tail->next) {
+        }
+        linkEtag();
+    }
+
+    static const std::string etagKey(etagHeader);
+    auto it = p_headers.find(etagKey);
+    const std::string_view wanted = it != p_headers.end() ? std::string_view(it->second) : std::string_view();
+    if (wanted != etag) {
+        unlinkEtag();
+        if (etagNode)
+            curl_slist_free_all(etagNode);
+        etagNode = nullptr;
+        etag.assign(wanted);
+        if (!etag.empty())
+            etagNode = curl_slist_append(nullptr, (std::string(etagHeader) + ": " + etag).c_str());
+        linkEtag();
+    }
+    return list ? list : etagNode;
+}
+
+CURLcode HttpClient::perform(CURL* p_curl, CancelToken* p_cancel) {
+    if (!p_cancel || !_multi)
+        return curl_easy_perform(p_curl);
+
+    if (curl_multi_add_handle(_multi, p_curl) != CURLM_OK)
+        return curl_easy_perform(p_curl);
+
+    CURLcode code = CURLE_ABORTED_BY_CALLBACK;
+    while (!p_cancel->load(std::memory_order_acquire)) {
+        int running = 0;
+        if (curl_multi_perform(_multi, &running) != CURLM_OK) {
+            code = CURLE_FAILED_INIT;
+            break;
+        }
+        int pending = 0;
+        bool done = false;
+        while (CURLMsg* msg = curl_multi_info_read(_multi, &pending)) {
+            if (msg->msg == CURLMSG_DONE && msg->easy_handle == p_curl) {
+                code = msg->data.result;
+                done = true;
+            }
+        }
+        if (done || running == 0)
+            break;
+        // The timeout only bounds the wait: socket activity, curl timers and interrupt() all return earlier.
+        curl_multi_poll(_multi, nullptr, 0, 1000, nullptr);
+    }
+    curl_multi_remove_handle(_multi, p_curl);
+    return code;
+}
+
 size_t HttpClient::writeCb(char* ptr, size_t size, size_t nmemb, void* userdata) {
     auto* out = static_cast<std::string*>(userdata);
     size_t totalSize = size * nmemb;
@@ -123,24 +290,35 @@ size_t HttpClient::writeCb(char* ptr, size_t size, size_t nmemb, void* userdata)
 }
 
 size_t HttpClient::headerCb(char* buffer, size_t size, size_t nitems, void* userdata) {
-    auto* headers = static_cast<std::map<std::string, std::string>*>(userdata);
+    auto* resp = static_cast<HttpResponse*>(userdata);
     size_t totalSize = size * nitems;
-    std::string line(buffer, totalSize);
+    const std::string_view line(buffer, totalSize);
 
     auto pos = line.find(':');
-    if (pos != std::string::npos) {
-        std::string key = line.substr(0, pos);
-        std::string val = line.substr(pos + 1);
+    if (pos == std::string_view::npos)
+        return totalSize;
+    const std::string_view key = trimView(line.substr(0, pos));
+    const std::string_view val = trimView(line.substr(pos + 1));
+    if (val.empty())
+        return totalSize;
 
-        // Trim whitespace efficiently
-        val = trimString(val, " \t\r\n");
-
-        // Convert key to lowercase
-        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
-
-        if (!key.empty() && !val.empty()) {
-            (*headers)[key] = val;
+    // Only the headers the SDK consumes are kept, the others are skipped without allocating:
+    static constexpr std::string_view consumed[] = {"etag", "content-length", "retry-after", "ratelimit-reset",
+                                                    "content-encoding"};
+    for (auto name : consumed) {
+        if (!equalsLowercase(key, name))
+            continue;
+        resp->headers[std::string(name)] = std::string(val);
+        if (name == "content-length") {
+            curl_off_t length = 0;
+            for (char c : val) {
+                if (c < '0' || c > '9' || length > maxBodyReserve)
+                    break;
+                length = length * 10 + (c - '0');
+            }
+            resp->body.reserve(static_cast<size_t>(std::min(length, maxBodyReserve)));
         }
+        break;
     }
     return totalSize;
 }
@@ -151,14 +329,4 @@ int HttpClient::xferInfoCb(void* clientp, curl_off_t, curl_off_t, curl_off_t, cu
     return flag->load() ? 1 : 0;
 }
 
-std::string HttpClient::trimString(const std::string& str, const char* whitespace) {
-    const size_t start = str.find_first_not_of(whitespace);
-    if (start == std::string::npos) {
-        return ""; // String is all whitespace
-    }
-
-    const size_t end = str.find_last_not_of(whitespace);
-    return str.substr(start, end - start + 1);
-}
-
 } // namespace unleash
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "internal/impressionSampler.hpp"
+
+#include <chrono>
+#include <functional>
+#include <random>
+
+namespace unleash {
+
+namespace {
+
+// Uniform in [0, 1), one xorshift step per call on a per-thread state.
+double nextUniform() {
+    thread_local std::uint64_t state = [] {
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) | rd() | 1u;
+    }();
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<double>((state * 0x2545F4914F6CDD1DULL) >> 11) * 0x1.0p-53;
+}
+
+} // namespace
+
+ImpressionSampler::ImpressionSampler(const ClientConfig& p_config)
+    : _sampleRate(p_config.impressionSampleRate()), _flagSampleRates(p_config.flagImpressionSampleRates()),
+      _firstN(p_config.impressionFirstN()), _firstNIntervalMs(p_config.impressionFirstNInterval().count()),
+      _dedupWindowMs(p_config.impressionDedupWindow().count()) {
+    _active = _sampleRate < 1.0 || !_flagSampleRates.empty() || (_firstN > 0 && _firstNIntervalMs > 0) ||
+              _dedupWindowMs > 0;
+}
+
+double ImpressionSampler::sampleRate(const std::string& p_flagName) const {
+    if (!_flagSampleRates.empty()) {
+        const auto it = _flagSampleRates.find(p_flagName);
+        if (it != _flagSampleRates.end())
+            return it->second;
+    }
+    return _sampleRate;
+}
+
+bool ImpressionSampler::admit(const std::string& p_flagName, bool p_enabled, const std::string& p_variant,
+                              std::uint64_t& p_suppressed) {
+    if (!_active) {
+        p_suppressed = 0;
+        return true;
+    }
+    return admit(p_flagName, p_enabled, p_variant, p_suppressed, nowMs());
+}
+
+bool ImpressionSampler::admit(const std::string& p_flagName, bool p_enabled, const std::string& p_variant,
+                              std::uint64_t& p_suppressed, std::int64_t p_nowMs) {
+    p_suppressed = 0;
+    if (!_active)
+        return true;
+
+    const double rate = sampleRate(p_flagName);
+    const bool sampledIn = rate >= 1.0 || (rate > 0.0 && nextUniform() < rate);
+
+    auto& shard = _shards[std::hash<std::string>{}(p_flagName) % shardCount];
+    std::lock_guard<std::mutex> lk(shard.mtx);
+    auto it = shard.flags.find(p_flagName);
+    if (it == shard.flags.end())
+        it = shard.flags.emplace(p_flagName, FlagState{}).first;
+    FlagState& state = it->second;
+
+    auto suppress = [&state] {
+        ++state.suppressed;
+        return false;
+    };
+
+    if (!sampledIn)
+        return suppress();
+
+    if (_dedupWindowMs > 0) {
+        // Entries past the window no longer suppress anything: dropped here, so that a flag only keeps the
+        // (enabled, variant) pairs it emitted within the last window.
+        auto& emitted = state.lastEmitted;
+        for (std::size_t i = 0; i < emitted.size();) {
+            if (p_nowMs - emitted[i].atMs >= _dedupWindowMs) {
+                emitted[i] = std::move(emitted.back());
+                emitted.pop_back();
+                continue;
+            }
+            if (emitted[i].enabled == p_enabled && emitted[i].variant == p_variant)
+                return suppress();
+            ++i;
+        }
+    }
+
+    if (_firstN > 0 && _firstNIntervalMs > 0) {
+        if (p_nowMs - state.windowStartMs >= _firstNIntervalMs) {
+            state.windowStartMs = p_nowMs;
+            state.emittedInWindow = 0;
+        }
+        if (state.emittedInWindow >= _firstN)
+            return suppress();
+        ++state.emittedInWindow;
+    }
+
+    if (_dedupWindowMs > 0)
+        state.lastEmitted.push_back(Emitted{p_enabled, p_variant, p_nowMs});
+
+    p_suppressed = state.suppressed;
+    state.suppressed = 0;
+    return true;
+}
+
+std::size_t ImpressionSampler::dedupEntries() {
+    std::size_t entries = 0;
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lk(shard.mtx);
+        for (const auto& flag : shard.flags)
+            entries += flag.second.lastEmitted.size();
+    }
+    return entries;
+}
+
+void ImpressionSampler::prepareFork() {
+    for (auto& shard : _shards)
+        shard.mtx.lock();
+}
+
+void ImpressionSampler::afterFork() {
+    for (auto it = _shards.rbegin(); it != _shards.rend(); ++it)
+        it->mtx.unlock();
+}
+
+std::int64_t ImpressionSampler::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace unleash
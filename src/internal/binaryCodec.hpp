@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "expected.hpp"
+#include "unleash/Domain/toggleSet.hpp"
+
+namespace unleash {
+
+// Flat binary encoding of a ToggleSet, used for snapshots shared between processes of the same host. The layout uses
+// native byte order and is not meant to be persisted or sent over the network.
+class BinaryCodec {
+  public:
+    static constexpr std::uint32_t magic = 0x55545342; // "UTSB"
+    static constexpr std::uint32_t formatVersion = 1;
+
+    static std::vector<char> encodeToggleSet(const ToggleSet& toggleSet);
+
+    static internal::Expected<ToggleSet, std::string> decodeToggleSet(const char* data, std::size_t size);
+};
+
+} // namespace unleash
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "unleash/EventHandler/clientEvents.hpp"
+#include "unleash/Utils/utils.hpp"
+
+namespace unleash {
+
+// Per-endpoint circuit breaker. Closed: calls go out, and failureThreshold consecutive failures open the circuit.
+// Open: calls are skipped until openDuration has elapsed, then the first one is let through as the half-open probe,
+// whose outcome closes the circuit or opens it again. Transitions are handed back for the caller to emit.
+// Not thread-safe: each breaker belongs to the thread (or serialized tasks) calling its endpoint.
+class CircuitBreaker {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Transition = std::optional<CircuitStateChange>;
+
+    // A zero threshold disables the breaker: every call is allowed and no transition happens.
+    CircuitBreaker(std::string p_endpoint, std::size_t p_failureThreshold, utils::mSeconds p_openDuration);
+
+    bool enabled() const noexcept {
+        return _failureThreshold > 0;
+    }
+
+    CircuitState state() const noexcept {
+        return _state;
+    }
+
+    // Whether a call may go out now.
+    bool tryAcquire(Transition& p_transition, Clock::time_point p_now = Clock::now());
+
+    Transition onSuccess();
+    Transition onFailure(Clock::time_point p_now = Clock::now());
+    // The acquired call was abandoned (cancelled) without an outcome.
+    void release() noexcept;
+
+    // Time left before the half-open probe (zero unless open).
+    utils::mSeconds remainingOpen(Clock::time_point p_now = Clock::now()) const;
+
+  private:
+    Transition moveTo(CircuitState p_state);
+
+    std::string _endpoint;
+    std::size_t _failureThreshold;
+    utils::mSeconds _openDuration;
+    CircuitState _state{CircuitState::Closed};
+    std::size_t _failures{0};
+    Clock::time_point _openUntil{};
+    bool _probeInFlight{false};
+};
+
+} // namespace unleash
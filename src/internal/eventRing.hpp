@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "unleash/EventHandler/clientEvents.hpp"
+
+namespace unleash {
+
+// One queued event. Records live in preallocated cells and are overwritten in place, so once the strings of a cell
+// have grown to the usual payload size an emit does not allocate.
+struct EventRecord {
+    ClientEvent type{ClientEvent::Init};
+    ClientError error;
+    ClientImpression impression{};
+    CircuitStateChange circuit{};
+    std::int64_t enqueuedNs = 0; // steady clock
+};
+
+// Bounded lock-free queue of EventRecord (Vyukov's array queue): every cell carries a sequence number telling
+// producers and consumers whose turn it is. Producers never block each other on a lock; a full ring rejects the push.
+class EventRing {
+  public:
+    // The capacity is rounded up to a power of two.
+    explicit EventRing(std::size_t p_minCapacity);
+
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return _mask + 1;
+    }
+
+    // Claims a free cell and lets p_fill write the record into it. Returns false when the ring is full.
+    template <typename Fill> bool tryPush(Fill&& p_fill) {
+        Cell* cell = nullptr;
+        std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &_cells[pos & _mask];
+            const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        p_fill(cell->record);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the oldest record into p_out (swapping buffers, so neither side reallocates). Returns false when empty.
+    bool tryPop(EventRecord& p_out);
+
+    // A snapshot only: producers may push right after it returns.
+    bool empty() const noexcept;
+
+  private:
+    struct Cell {
+        std::atomic<std::size_t> seq{0};
+        EventRecord record;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    std::size_t _mask;
+    alignas(64) std::atomic<std::size_t> _enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> _dequeuePos{0};
+};
+
+} // namespace unleash
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace unleash {
+
+// fork() support: only the forking thread exists in the child. The handle of a thread inherited from the parent can
+// be neither joined nor detached there (its descriptor may already be reused): it is dropped without a call.
+inline void forgetThread(std::thread& p_thread) {
+    new (&p_thread) std::thread();
+}
+
+// Same for an object owning such threads, e.g. a ThreadScheduler: its destructor would join them, so it is leaked.
+template <typename T> void abandonAfterFork(std::shared_ptr<T>& p_object) {
+    static_cast<void>(new std::shared_ptr<T>(std::move(p_object)));
+}
+
+} // namespace unleash
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "unleash/Configuration/clientConfig.hpp"
+
+namespace unleash {
+
+// Decides, before an impression is built or queued, whether it is emitted. Impressions are kept with the global or
+// per-flag sample rate, then dropped if an identical one (flag, enabled, variant) was emitted within the dedup window,
+// or if the flag already emitted its first N of the current interval. The number of impressions of a flag suppressed
+// since its last emitted one is handed back, so that consumers can scale counts.
+class ImpressionSampler {
+  public:
+    explicit ImpressionSampler(const ClientConfig& p_config);
+
+    ImpressionSampler(const ImpressionSampler&) = delete;
+    ImpressionSampler& operator=(const ImpressionSampler&) = delete;
+
+    // False when every impression is emitted: admit() then never takes a lock.
+    bool active() const noexcept {
+        return _active;
+    }
+
+    bool admit(const std::string& p_flagName, bool p_enabled, const std::string& p_variant,
+               std::uint64_t& p_suppressed);
+
+    bool admit(const std::string& p_flagName, bool p_enabled, const std::string& p_variant,
+               std::uint64_t& p_suppressed, std::int64_t p_nowMs);
+
+    // (flag, enabled, variant) emissions currently remembered by the dedup window.
+    std::size_t dedupEntries();
+
+    // fork() support: every shard is locked across the fork; the child keeps the parent's state.
+    void prepareFork();
+    void afterFork();
+
+  private:
+    struct Emitted {
+        bool enabled;
+        std::string variant;
+        std::int64_t atMs;
+    };
+
+    struct FlagState {
+        std::int64_t windowStartMs = 0;
+        std::size_t emittedInWindow = 0;
+        std::uint64_t suppressed = 0;
+        std::vector<Emitted> lastEmitted; // per (enabled, variant) emitted within the dedup window
+    };
+
+    struct Shard {
+        std::mutex mtx;
+        std::unordered_map<std::string, FlagState> flags;
+    };
+
+    static constexpr std::size_t shardCount = 16;
+
+    double sampleRate(const std::string& p_flagName) const;
+
+    static std::int64_t nowMs();
+
+    double _sampleRate;
+    std::unordered_map<std::string, double> _flagSampleRates;
+    std::size_t _firstN;
+    std::int64_t _firstNIntervalMs;
+    std::int64_t _dedupWindowMs;
+    bool _active;
+
+    std::array<Shard, shardCount> _shards;
+};
+
+} // namespace unleash
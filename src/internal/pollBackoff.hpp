@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <random>
+
+#include "unleash/Configuration/clientConfig.hpp"
+
+namespace unleash {
+
+// Delay before the next toggle poll. Successes poll at the refresh interval; consecutive failures back off with full
+// jitter above the refresh interval (uniform in [interval, min(max, interval * 2^failures)]), never sooner than the
+// server's Retry-After, which is itself capped at the max (a bogus or hostile value cannot stop polling for hours).
+// The first poll is delayed by a random share of the startup jitter, so that a fleet restarted
+// together does not poll in lockstep.
+class PollBackoff {
+  public:
+    explicit PollBackoff(const ClientConfig& p_config);
+    PollBackoff(const ClientConfig& p_config, std::uint64_t p_seed);
+
+    utils::mSeconds startupDelay();
+
+    // Resets the failure count: back to the refresh interval right away.
+    utils::mSeconds onSuccess();
+
+    utils::mSeconds onFailure(std::optional<utils::mSeconds> p_retryAfter = std::nullopt);
+
+    unsigned failures() const noexcept {
+        return _failures;
+    }
+
+  private:
+    utils::mSeconds uniform(utils::mSeconds p_upper);
+
+    utils::mSeconds _interval;
+    utils::mSeconds _max;
+    utils::mSeconds _startupJitter;
+    unsigned _failures{0};
+    std::mt19937_64 _rng;
+};
+
+} // namespace unleash
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace unleash {
+
+// Ties tasks posted to an IScheduler to the lifetime of their owner: once close() returns, wrapped tasks that had not
+// started are skipped and none is running anymore. open() starts a new generation, e.g. on restart. The generation is
+// swapped atomically: wrap() may run on any thread, concurrently with open().
+class TaskGuard {
+  public:
+    void open() {
+        std::atomic_store_explicit(&_state, std::make_shared<State>(), std::memory_order_release);
+    }
+
+    void close() {
+        const auto state = std::atomic_load_explicit(&_state, std::memory_order_acquire);
+        std::unique_lock<std::mutex> lk(state->mtx);
+        state->open = false;
+        state->cv.wait(lk, [&state] { return state->running == 0; });
+    }
+
+    // fork() support: the generation is locked across the fork. In the child, the tasks it was running are the
+    // parent's: it is closed without waiting for them, and replaced by a new one if it was open.
+    void prepareFork() {
+        _forkState = std::atomic_load_explicit(&_state, std::memory_order_acquire);
+        _forkState->mtx.lock();
+    }
+
+    void parentAfterFork() {
+        std::exchange(_forkState, nullptr)->mtx.unlock();
+    }
+
+    void childAfterFork() {
+        const auto state = std::exchange(_forkState, nullptr);
+        const bool wasOpen = std::exchange(state->open, false);
+        state->mtx.unlock();
+        if (wasOpen)
+            open();
+    }
+
+    std::function<void()> wrap(std::function<void()> p_task) const {
+        return [state = std::atomic_load_explicit(&_state, std::memory_order_acquire), task = std::move(p_task)] {
+            {
+                std::lock_guard<std::mutex> lk(state->mtx);
+                if (!state->open)
+                    return;
+                ++state->running;
+            }
+            struct Done {
+                State& state;
+                ~Done() {
+                    {
+                        std::lock_guard<std::mutex> lk(state.mtx);
+                        --state.running;
+                    }
+                    state.cv.notify_all();
+                }
+            } done{*state};
+            task();
+        };
+    }
+
+  private:
+    struct State {
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool open = true;
+        int running = 0;
+    };
+
+    std::shared_ptr<State> _state = std::make_shared<State>();
+    std::shared_ptr<State> _forkState; // locked by prepareFork()
+};
+
+} // namespace unleash
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include "unleash/Client/unleashClient.hpp"
+#include "unleash/Configuration/clientConfig.hpp"
+#include "unleash/Domain/context.hpp"
+#include "unleash/Domain/toggleSet.hpp"
+#include "unleash/Domain/variant.hpp"
+#include "unleash/EventHandler/eventHandler.hpp"
+#include "unleash/Store/flagStore.hpp"
+#include "unleash/Metrics/metricStore.hpp"
+#include "unleash/Metrics/metricSender.hpp"
+#include "unleash/Fetcher/toggleFetcher.hpp"
+#include "unleash/Store/storageProvider.hpp"
+#include "internal/impressionSampler.hpp"
+#include "internal/pollBackoff.hpp"
+#include "internal/circuitBreaker.hpp"
+#include "internal/taskGuard.hpp"
+#include "unleash/Scheduler/scheduler.hpp"
+
+namespace unleash {
+
+class UnleashClient::Impl {
+  public:
+    Impl(ClientConfig p_config, Context p_ctx);
+
+    ~Impl();
+
+    Impl(const Impl&) = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    void start();
+    void stop();
+
+    bool isRunning() const noexcept;
+    bool isReady() const noexcept;
+
+    bool isEnabled(const std::string& flagName);
+
+    Variant getVariant(const std::string& flagName);
+    bool impressionData(const std::string& flagName) const;
+
+    Context context() const;
+    void updateContext(const MutableContext& p_mCtx);
+
+    EventStats eventStats() const;
+
+    EventHandler& eventHandler() {
+        return *_eventHandler;
+    }
+
+  private:
+    void startThreads();
+
+    // p_flushMetrics: send the remaining metrics within metricsFlushOnStop() once the threads are gone.
+    void stopThreads(bool p_flushMetrics);
+
+    // fork() support (POSIX only): the handlers walk every live client.
+    void registerForkHandlers();
+    static void prepareFork();
+    static void parentAfterFork();
+    static void childAfterFork();
+    void quiesceForFork();
+    void lockForFork();
+    void releaseAfterFork();
+    void rearmAfterFork();
+
+    std::shared_ptr<const Context> contextSnapshot() const;
+
+    // Snapshot and version read together, under _mutexPolling; beginFetch() also re-arms _fetchCancel.
+    std::pair<std::shared_ptr<const Context>, std::uint64_t> beginFetch();
+    std::uint64_t contextVersion();
+
+    bool isStoreReady();
+
+    // Segment readers (see ClientConfig::setSharedToggleSegment()) follow the published snapshots from a task of the
+    // polling scheduler, every utils::sharedSegmentPollInterval; evaluations never decode.
+    bool followsSegment() const;
+    void scheduleSegmentRefresh();
+
+    void initializeToggleCache();
+
+    // Connection pre-warming (ClientConfig::setPreconnect()), one per transport client so that the first fetch and
+    // the first metrics send each wait only for their own connection.
+    struct WarmUp {
+        std::thread thread; // guarded by mutex
+        std::atomic_bool pending{false};
+        IComClient::CancelToken cancel{false};
+        std::mutex mutex;
+    };
+    // Started by the constructor; joined before the first fetch (resp. metrics send). p_abort cancels it first, which
+    // stop() and fork() do as its thread would outlive the former and not survive the latter.
+    void startWarmUp();
+    void finishWarmUp(WarmUp& p_warmUp, bool p_abort = false);
+    void abortWarmUps();
+
+    void persistToggles(const ToggleSet& p_toggles);
+
+    // The application's scheduler (ClientConfig::setScheduler()), else a ThreadScheduler of its own.
+    std::shared_ptr<IScheduler> backgroundScheduler() const;
+
+    // One polling/metrics round per task, each posting the next one.
+    void pollTask();
+    void metricsTask();
+    void schedulePoll(utils::mSeconds p_delay);
+    void scheduleMetrics(utils::mSeconds p_delay);
+
+    void sendMetricsAndReport();
+
+    std::optional<MetricSender::MetricResult> sendMetrics();
+
+    std::optional<std::string> takeMetricsPayload();
+
+    MetricSender::MetricResult sendMetricsPayload(std::string p_payload, utils::mSeconds p_timeout);
+
+    void flushMetricsOnStop();
+
+    // Asks the metrics breaker for a call, emitting its transition if any.
+    bool acquireMetricsCall();
+    void emitCircuitTransition(const CircuitBreaker::Transition& p_transition);
+
+    // Returns the delay before the next poll.
+    utils::mSeconds singleFetchToggles();
+
+    void applyToggles(ToggleSet p_toggles);
+
+    ClientConfig _config;
+    // Immutable snapshot, replaced as a whole by updateContext():
+    std::shared_ptr<const Context> _context;
+    // stores:
+    FlagStore _flagStore;
+    MetricsStore _metricStore;
+    ImpressionSampler _impressionSampler;
+    // Used by the polling task only:
+    PollBackoff _pollBackoff;
+    // Used by the polling (resp. metrics) task only; errors are reported while the circuit is closed. The
+    // fetch breaker is an aggregate over all the toggle endpoints:
+    CircuitBreaker _fetchBreaker;
+    CircuitBreaker _metricsBreaker;
+    // senders:
+    MetricSender _metricSender;
+    // toggle Fetcher:
+    ToggleFetcher _toggleFetcher;
+    // even handler:
+    std::shared_ptr<EventHandler> _eventHandler;
+
+    std::atomic_bool _running{false};
+    std::atomic_bool _ready{false};
+    std::atomic_bool _exitThreads{false};
+    bool _contextUpdated{false};
+    // Set by stop() to abort in-flight transfers:
+    IComClient::CancelToken _cancel{false};
+    // Set by stop() and by updateContext() to abort the in-flight fetch; reset under _mutexPolling by the next one:
+    IComClient::CancelToken _fetchCancel{false};
+    std::uint64_t _contextVersion{0}; // guarded by _mutexPolling
+    // Last applied MutableContext::fingerprint() and time of that update, guarded by _mutexPolling:
+    std::uint64_t _contextFingerprint{0};
+    std::chrono::steady_clock::time_point _lastContextUpdate{};
+    // Payload whose transfer was aborted, sent with the next round or the final flush:
+    std::optional<std::string> _unsentMetrics;
+
+    WarmUp _fetchWarmUp, _metricsWarmUp;
+    // multithreading Data race handling :
+    std::mutex _mutexMetrics, _mutexPolling;
+    // Held by a polling (resp. metrics) task for its whole round, so that fork() waits for the transfer in flight:
+    std::mutex _pollRoundMutex, _metricsRoundMutex;
+
+    // Polling and metrics tasks run on their own scheduler each while started (see backgroundScheduler()), so that a
+    // slow fetch does not hold metrics back. Own schedulers are joined by stopThreads().
+    std::shared_ptr<IScheduler> _pollScheduler;    // guarded by _mutexPolling
+    std::shared_ptr<IScheduler> _metricsScheduler; // guarded by _mutexMetrics
+    TaskGuard _taskGuard;
+    IScheduler::TaskId _pollTaskId{0};    // guarded by _mutexPolling
+    IScheduler::TaskId _segmentTaskId{0}; // guarded by _mutexPolling
+    IScheduler::TaskId _metricsTaskId{0}; // guarded by _mutexMetrics
+
+    // sdkState:
+    SdkState _sdkState{SdkState::Stopped};
+};
+
+} // namespace unleash
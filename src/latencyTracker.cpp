@@ -0,0 +1,25 @@
+#include "unleash/Fetcher/latencyTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace unleash {
+
+void LatencyTracker::add(utils::mSeconds p_latency) noexcept {
+    _samples[_next] = p_latency.count();
+    _next = (_next + 1) % windowSize;
+    _count = std::min(_count + 1, windowSize);
+}
+
+std::optional<utils::mSeconds> LatencyTracker::percentile(double p_quantile) const {
+    if (_count < minSamples || !(p_quantile > 0.0))
+        return std::nullopt;
+    std::array<std::int64_t, windowSize> sorted;
+    std::copy_n(_samples.begin(), _count, sorted.begin());
+    const auto rank = static_cast<std::size_t>(std::ceil(std::min(p_quantile, 1.0) * static_cast<double>(_count)));
+    const auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(std::max<std::size_t>(rank, 1) - 1);
+    std::nth_element(sorted.begin(), nth, sorted.begin() + static_cast<std::ptrdiff_t>(_count));
+    return utils::mSeconds{*nth};
+}
+
+} // namespace unleash
@@ -24,4 +24,19 @@ void MetricList::addVariantMetricData(const std::string& p_toggleName, bool p_is
     _metricList.emplace(p_toggleName, MetricToggle(p_toggleName, p_isYes, p_variantName));
 }
 
-} // namespace unleash
\ No newline at end of file
+void MetricList::addCounts(const std::string& p_toggleName, unsigned int p_yesCount, unsigned int p_noCount) {
+    auto it = _metricList.try_emplace(p_toggleName, p_toggleName).first;
+    it->second.addCounts(p_yesCount, p_noCount);
+}
+
+void MetricList::addVariantCount(const std::string& p_toggleName, const std::string& p_variantName,
+                                 unsigned int p_count) {
+    auto it = _metricList.try_emplace(p_toggleName, p_toggleName).first;
+    it->second.addVariantCount(p_variantName, p_count);
+}
+
+bool MetricList::empty() const {
+    return _metricList.empty();
+}
+
+} // namespace unleash
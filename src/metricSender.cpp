@@ -7,9 +7,11 @@ MetricSender::MetricSender(const ClientConfig& p_config) {
     initializeHttpRequest(p_config);
 }
 
-MetricSender::MetricResult MetricSender::sendMetrics(const std::string& p_metricBody) {
+MetricSender::MetricResult MetricSender::sendMetrics(const std::string& p_metricBody, IComClient::CancelToken* p_cancel,
+                                                     utils::mSeconds p_timeout) {
     _httpRequest.body = p_metricBody;
-    auto resp = _httpClient.request(_httpRequest);
+    _httpRequest.timeoutMs = p_timeout.count() > 0 ? static_cast<long>(p_timeout.count()) : _timeoutMs;
+    auto resp = _httpClient.request(_httpRequest, p_cancel);
     MetricSender::MetricResult result;
 
     if (!resp) {
@@ -54,7 +56,9 @@ MetricSender::MetricResult MetricSender::sendMetrics(const std::string& p_metric
 void MetricSender::initializeHttpRequest(const ClientConfig& p_config) {
     _httpRequest.url = p_config.url() + "/client/metrics";
     _httpRequest.usePOSTrequests = true;
-    _httpRequest.timeoutMs = static_cast<long>(p_config.timeOutQueryMS().count());
+    _timeoutMs = static_cast<long>(p_config.timeOutQueryMS().count());
+    _httpRequest.timeoutMs = _timeoutMs;
+    _httpRequest.unixSocketPath = p_config.unixSocketPath();
     _httpRequest.headers.clear();
 
     _httpRequest.headers["accept"] = "application/json";
@@ -1,4 +1,5 @@
 #include "unleash/Metrics/metricStore.hpp"
+#include "unleash/Metrics/sharedMetricsSegment.hpp"
 #include "internal/jsonCodec.hpp"
 #include "unleash/Utils/utils.hpp"
 #include <cstdint>
@@ -9,6 +10,7 @@ MetricsStore::MetricsStore(const ClientConfig& p_cfg) {
     _startMs = nowMs();
     _appName = p_cfg.appName();
     _instanceId = p_cfg.instanceId();
+    _shared = p_cfg.sharedMetricsSegment();
 }
 
 void MetricsStore::reset() {
@@ -18,11 +20,21 @@ void MetricsStore::reset() {
 }
 
 void MetricsStore::addVariantMetric(const std::string& p_toggleName, bool p_isYes, const std::string& p_variantName) {
+    // Shared mode goes straight to the segment's counters, which are atomics of this process' slab:
+    if (_shared) {
+        _shared->addVariantMetric(p_toggleName, p_isYes, p_variantName);
+        return;
+    }
     std::lock_guard<std::mutex> g(_mtx);
     _list.addVariantMetricData(p_toggleName, p_isYes, p_variantName);
 }
 
 void MetricsStore::addEnableMetric(const std::string& p_toggleName, bool p_isYes) {
+    // Shared mode goes straight to the segment's counters, which are atomics of this process' slab:
+    if (_shared) {
+        _shared->addEnableMetric(p_toggleName, p_isYes);
+        return;
+    }
     std::lock_guard<std::mutex> g(_mtx);
     _list.addEnableMetricData(p_toggleName, p_isYes);
 }
@@ -62,6 +74,53 @@ std::optional<std::string> MetricsStore::toJsonMetricsPayload() const {
                                                utils::fromMsTsToUtcTime(stopMs), _appName, _instanceId);
 }
 
+std::optional<std::string> MetricsStore::takeJsonMetricsPayload(utils::mSeconds p_lease) {
+    MetricList taken;
+    std::int64_t startMs = 0;
+    std::int64_t stopMs = 0;
+
+    {
+        std::lock_guard<std::mutex> g(_mtx);
+        stopMs = nowMs();
+
+        if (_shared) {
+            if (!_shared->tryLead(p_lease))
+                return std::nullopt;
+            taken = _shared->drain(startMs);
+        } else {
+            std::swap(taken, _list);
+            startMs = _startMs;
+            _startMs = stopMs;
+        }
+    }
+
+    if (taken.empty())
+        return std::nullopt;
+
+    return JsonCodec::encodeMetricsRequestBody(taken, utils::fromMsTsToUtcTime(startMs),
+                                               utils::fromMsTsToUtcTime(stopMs), _appName, _instanceId);
+}
+
+void MetricsStore::prepareFork() {
+    _mtx.lock();
+    if (_shared)
+        _shared->prepareFork();
+}
+
+void MetricsStore::parentAfterFork() {
+    if (_shared)
+        _shared->parentAfterFork();
+    _mtx.unlock();
+}
+
+void MetricsStore::childAfterFork() {
+    _list = MetricList{};
+    _startMs = nowMs();
+    if (_shared)
+        _shared->childAfterFork();
+    _mtx.unlock();
+}
+
 std::int64_t MetricsStore::nowMs() {
     const auto now = clock::now().time_since_epoch();
     return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
@@ -1,6 +1,8 @@
 #include "unleash/Metrics/metricToggle.hpp"
 
 namespace unleash {
+MetricToggle::MetricToggle(const std::string& p_toggleName) : _toggleName(p_toggleName) {}
+
 MetricToggle::MetricToggle(const std::string& p_toggleName, bool p_isYes) : _toggleName(p_toggleName) {
     updateEnableMetric(p_isYes);
 }
@@ -43,4 +45,14 @@ void MetricToggle::updateVariantMetric(bool p_isYes, const std::string& p_varian
         ++_variantsStats[p_variantName];
 }
 
-} // namespace unleash
\ No newline at end of file
+void MetricToggle::addCounts(unsigned int p_yesCount, unsigned int p_noCount) {
+    _yesCount += p_yesCount;
+    _noCount += p_noCount;
+}
+
+void MetricToggle::addVariantCount(const std::string& p_variantName, unsigned int p_count) {
+    if (!p_variantName.empty() && p_count > 0)
+        _variantsStats[p_variantName] += p_count;
+}
+
+} // namespace unleash
@@ -0,0 +1,45 @@
+#include "internal/pollBackoff.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace unleash {
+
+PollBackoff::PollBackoff(const ClientConfig& p_config) : PollBackoff(p_config, std::random_device{}()) {}
+
+PollBackoff::PollBackoff(const ClientConfig& p_config, std::uint64_t p_seed)
+    : _interval(std::chrono::duration_cast<utils::mSeconds>(p_config.refreshInterval())),
+      _max(std::max(_interval, std::chrono::duration_cast<utils::mSeconds>(p_config.pollBackoffMax()))),
+      _startupJitter(p_config.pollStartupJitter()), _rng(p_seed) {}
+
+utils::mSeconds PollBackoff::startupDelay() {
+    return _startupJitter.count() > 0 ? uniform(_startupJitter) : utils::mSeconds{0};
+}
+
+utils::mSeconds PollBackoff::onSuccess() {
+    _failures = 0;
+    return _interval;
+}
+
+utils::mSeconds PollBackoff::onFailure(std::optional<utils::mSeconds> p_retryAfter) {
+    ++_failures;
+    // interval * 2^failures, saturating at the max:
+    utils::mSeconds ceiling = _interval;
+    for (unsigned i = 0; i < _failures && ceiling < _max; ++i)
+        ceiling *= 2;
+    ceiling = std::min(ceiling, _max);
+
+    // Drawn above the interval rather than clamped up to it, which would put interval / ceiling of the fleet on the
+    // same instant:
+    auto delay = _interval + uniform(ceiling - _interval);
+    if (p_retryAfter.has_value())
+        delay = std::max(delay, std::min(*p_retryAfter, _max));
+    return delay;
+}
+
+utils::mSeconds PollBackoff::uniform(utils::mSeconds p_upper) {
+    std::uniform_int_distribution<utils::mSeconds::rep> dist(0, p_upper.count());
+    return utils::mSeconds{dist(_rng)};
+}
+
+} // namespace unleash
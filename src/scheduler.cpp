@@ -0,0 +1,72 @@
+#include "unleash/Scheduler/scheduler.hpp"
+
+#include <iostream>
+
+namespace unleash {
+
+ThreadScheduler::ThreadScheduler() : _thread(&ThreadScheduler::run, this) {}
+
+ThreadScheduler::~ThreadScheduler() {
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        _stopping = true;
+    }
+    _cv.notify_all();
+    if (_thread.joinable())
+        _thread.join();
+}
+
+IScheduler::TaskId ThreadScheduler::post(Task p_task) {
+    return postAfter(utils::mSeconds{0}, std::move(p_task));
+}
+
+IScheduler::TaskId ThreadScheduler::postAfter(utils::mSeconds p_delay, Task p_task) {
+    TaskId id = 0;
+    {
+        std::lock_guard<std::mutex> lk(_mtx);
+        id = _nextId++;
+        _tasks.emplace(id, std::move(p_task));
+        _timers.push(Timer{Clock::now() + p_delay, id});
+    }
+    _cv.notify_one();
+    return id;
+}
+
+bool ThreadScheduler::cancel(TaskId p_id) {
+    // The timer stays queued and is skipped once due.
+    std::lock_guard<std::mutex> lk(_mtx);
+    return _tasks.erase(p_id) > 0;
+}
+
+void ThreadScheduler::run() {
+    std::unique_lock<std::mutex> lk(_mtx);
+    while (!_stopping) {
+        if (_timers.empty()) {
+            _cv.wait(lk, [this] { return _stopping || !_timers.empty(); });
+            continue;
+        }
+        const Timer next = _timers.top();
+        if (Clock::now() < next.due) {
+            _cv.wait_until(lk, next.due);
+            continue;
+        }
+        _timers.pop();
+        auto it = _tasks.find(next.id);
+        if (it == _tasks.end())
+            continue; // cancelled
+        Task task = std::move(it->second);
+        _tasks.erase(it);
+
+        lk.unlock();
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "ThreadScheduler: Exception in task: " << e.what() << '\n';
+        } catch (...) {
+            std::cerr << "ThreadScheduler: Unknown exception in task\n";
+        }
+        lk.lock();
+    }
+}
+
+} // namespace unleash
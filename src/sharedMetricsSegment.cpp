@@ -0,0 +1,389 @@
+#include "unleash/Metrics/sharedMetricsSegment.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace unleash {
+
+namespace {
+
+constexpr std::uint32_t segmentMagic = 0x554D5353; // "UMSS"
+constexpr std::uint32_t segmentLayoutVersion = 1;
+constexpr std::uint32_t slotFree = 0;
+constexpr std::uint32_t slotReady = 2;
+constexpr std::size_t cacheLine = 64;
+
+std::string shmName(const std::string& p_name) {
+    return (!p_name.empty() && p_name.front() == '/') ? p_name : "/" + p_name;
+}
+
+std::size_t alignUp(std::size_t p_value) {
+    return (p_value + cacheLine - 1) / cacheLine * cacheLine;
+}
+
+std::int64_t nowMs() {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+} // namespace
+
+struct SharedMetricsSegment::Header {
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t layoutVersion;
+    std::uint32_t maxWorkers;
+    std::uint32_t maxSlots;
+    // Sender lease: holder pid in the high half, expiry (epoch seconds) in the low half.
+    std::atomic<std::uint64_t> lease;
+    std::atomic<std::int64_t> windowStartMs;
+    std::atomic<std::uint32_t> slotCount;
+    std::atomic<std::uint64_t> dropped;
+};
+
+struct SharedMetricsSegment::Slot {
+    std::atomic<std::uint32_t> state;
+    char toggleName[maxNameLength + 1];
+    char variantName[maxNameLength + 1];
+};
+
+// For variant slots only `yes` is used, as the variant hit count.
+struct SharedMetricsSegment::Counter {
+    std::atomic<std::uint64_t> yes;
+    std::atomic<std::uint64_t> no;
+};
+
+SharedMetricsSegment::Layout SharedMetricsSegment::computeLayout(std::uint32_t p_maxWorkers,
+                                                                 std::uint32_t p_maxSlots) {
+    Layout l{};
+    l.slotsOffset = alignUp(sizeof(Header));
+    l.workersOffset = alignUp(l.slotsOffset + p_maxSlots * sizeof(Slot));
+    l.countersOffset = alignUp(l.workersOffset + p_maxWorkers * sizeof(std::atomic<std::uint32_t>));
+    l.slabSize = alignUp(p_maxSlots * sizeof(Counter));
+    l.total = l.countersOffset + p_maxWorkers * l.slabSize;
+    return l;
+}
+
+SharedMetricsSegment::SharedMetricsSegment(void* p_mapping, std::size_t p_mappingSize)
+    : _mapping(p_mapping), _mappingSize(p_mappingSize), _header(static_cast<Header*>(p_mapping)),
+      _layout(computeLayout(_header->maxWorkers, _header->maxSlots)), _slotCache(std::make_shared<const SlotCache>()) {}
+
+SharedMetricsSegment::Slot* SharedMetricsSegment::slots() const noexcept {
+    return reinterpret_cast<Slot*>(static_cast<char*>(_mapping) + _layout.slotsOffset);
+}
+
+std::atomic<std::uint32_t>* SharedMetricsSegment::workerPids() const noexcept {
+    return reinterpret_cast<std::atomic<std::uint32_t>*>(static_cast<char*>(_mapping) + _layout.workersOffset);
+}
+
+SharedMetricsSegment::Counter* SharedMetricsSegment::counters(std::uint32_t p_worker) const noexcept {
+    return reinterpret_cast<Counter*>(static_cast<char*>(_mapping) + _layout.countersOffset +
+                                      p_worker * _layout.slabSize);
+}
+
+#if defined(_WIN32)
+
+std::shared_ptr<SharedMetricsSegment> SharedMetricsSegment::attach(const std::string&, std::uint32_t, std::uint32_t) {
+    return nullptr;
+}
+
+bool SharedMetricsSegment::remove(const std::string&) {
+    return false;
+}
+
+SharedMetricsSegment::~SharedMetricsSegment() = default;
+
+bool SharedMetricsSegment::registerWorker() {
+    return false;
+}
+
+bool SharedMetricsSegment::tryLead(utils::mSeconds) {
+    return false;
+}
+
+#else
+
+std::shared_ptr<SharedMetricsSegment> SharedMetricsSegment::attach(const std::string& p_name,
+                                                                   std::uint32_t p_maxWorkers,
+                                                                   std::uint32_t p_maxSlots) {
+    if (p_maxWorkers == 0 || p_maxSlots == 0)
+        return nullptr;
+
+    const std::string name = shmName(p_name);
+    void* mapping = MAP_FAILED;
+    std::size_t mappingSize = 0;
+
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd >= 0) {
+        const auto l = computeLayout(p_maxWorkers, p_maxSlots);
+        mappingSize = l.total;
+        if (::ftruncate(fd, static_cast<off_t>(mappingSize)) == 0)
+            mapping = ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        // ftruncate zero-fills the segment: slots are free, counters and pids are 0.
+        auto* header = new (mapping) Header{};
+        header->layoutVersion = segmentLayoutVersion;
+        header->maxWorkers = p_maxWorkers;
+        header->maxSlots = p_maxSlots;
+        header->windowStartMs.store(nowMs(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic.store(segmentMagic, std::memory_order_release);
+    } else {
+        if (errno != EEXIST)
+            return nullptr;
+        fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            return nullptr;
+
+        // The creator may still be sizing the segment:
+        struct stat st {};
+        for (int attempt = 0; attempt < 1000; ++attempt) {
+            if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Header))
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        mappingSize = static_cast<std::size_t>(st.st_size);
+        if (mappingSize >= sizeof(Header))
+            mapping = ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            return nullptr;
+
+        auto* header = static_cast<Header*>(mapping);
+        for (int attempt = 0; attempt < 1000 && header->magic.load(std::memory_order_acquire) != segmentMagic;
+             ++attempt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        if (header->magic.load(std::memory_order_acquire) != segmentMagic ||
+            header->layoutVersion != segmentLayoutVersion ||
+            computeLayout(header->maxWorkers, header->maxSlots).total != mappingSize) {
+            ::munmap(mapping, mappingSize);
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<SharedMetricsSegment> segment(new SharedMetricsSegment(mapping, mappingSize));
+    if (!segment->registerWorker())
+        return nullptr;
+    return segment;
+}
+
+bool SharedMetricsSegment::remove(const std::string& p_name) {
+    return ::shm_unlink(shmName(p_name).c_str()) == 0;
+}
+
+SharedMetricsSegment::~SharedMetricsSegment() {
+    if (!_mapping)
+        return;
+    // Counters of the slab stay in place and are picked up by the next drain.
+    if (_worker >= 0) {
+        auto expected = static_cast<std::uint32_t>(::getpid());
+        workerPids()[_worker].compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+    }
+    ::munmap(_mapping, _mappingSize);
+}
+
+bool SharedMetricsSegment::registerWorker() {
+    const auto self = static_cast<std::uint32_t>(::getpid());
+    std::atomic<std::uint32_t>* pids = workerPids();
+
+    for (std::uint32_t w = 0; w < _header->maxWorkers; ++w) {
+        std::uint32_t owner = pids[w].load(std::memory_order_acquire);
+        const bool dead = owner != 0 && owner != self && ::kill(static_cast<pid_t>(owner), 0) != 0 && errno == ESRCH;
+        if (owner == self || ((owner == 0 || dead) &&
+                              pids[w].compare_exchange_strong(owner, self, std::memory_order_acq_rel))) {
+            _worker = w;
+            return true;
+        }
+    }
+    _worker = -1;
+    return false;
+}
+
+bool SharedMetricsSegment::tryLead(utils::mSeconds p_lease) {
+    const auto self = static_cast<std::uint64_t>(::getpid());
+    const auto now = static_cast<std::uint64_t>(nowMs() / 1000);
+    const auto leaseSeconds = static_cast<std::uint64_t>(std::max<std::int64_t>(1, (p_lease.count() + 999) / 1000));
+
+    std::uint64_t current = _header->lease.load(std::memory_order_acquire);
+    const std::uint64_t holder = current >> 32;
+    const std::uint64_t expiry = current & 0xFFFFFFFFu;
+    if (holder != 0 && holder != self && expiry > now)
+        return false;
+
+    const std::uint64_t desired = (self << 32) | ((now + leaseSeconds) & 0xFFFFFFFFu);
+    return _header->lease.compare_exchange_strong(current, desired, std::memory_order_acq_rel);
+}
+
+#endif
+
+std::uint64_t SharedMetricsSegment::droppedCount() const noexcept {
+    return _header->dropped.load(std::memory_order_relaxed);
+}
+
+std::uint32_t SharedMetricsSegment::slotCount() const noexcept {
+    return _header->slotCount.load(std::memory_order_acquire);
+}
+
+void SharedMetricsSegment::prepareFork() {
+    if (_forkHolders++ == 0)
+        _cacheMutex.lock();
+}
+
+void SharedMetricsSegment::parentAfterFork() {
+    if (--_forkHolders == 0)
+        _cacheMutex.unlock();
+}
+
+void SharedMetricsSegment::childAfterFork() {
+    if (--_forkHolders > 0)
+        return;
+    _cacheMutex.unlock();
+    registerWorker();
+}
+
+std::int64_t SharedMetricsSegment::findOrAllocateSlot(const std::string& p_toggleName,
+                                                      const std::string& p_variantName) {
+    if (p_toggleName.size() > maxNameLength || p_variantName.size() > maxNameLength)
+        return -1;
+
+    Slot* table = slots();
+    std::uint32_t count = _header->slotCount.load(std::memory_order_acquire);
+    for (std::uint32_t s = 0; s < std::min(count, _header->maxSlots); ++s) {
+        if (table[s].state.load(std::memory_order_acquire) == slotReady && p_toggleName == table[s].toggleName &&
+            p_variantName == table[s].variantName)
+            return s;
+    }
+
+    // Never moves slotCount past maxSlots, so a full table stays full instead of wrapping onto live slots.
+    // Two processes may allocate a slot for the same name concurrently, drain() merges them by name.
+    do {
+        if (count >= _header->maxSlots)
+            return -1;
+    } while (!_header->slotCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire));
+
+    std::memcpy(table[count].toggleName, p_toggleName.c_str(), p_toggleName.size() + 1);
+    std::memcpy(table[count].variantName, p_variantName.c_str(), p_variantName.size() + 1);
+    table[count].state.store(slotReady, std::memory_order_release);
+    return count;
+}
+
+std::optional<std::uint32_t> SharedMetricsSegment::cachedSlot(const SlotCache& p_cache,
+                                                              const std::string& p_toggleName,
+                                                              const std::string& p_variantName) {
+    auto it = p_cache.find(p_toggleName);
+    if (it == p_cache.end())
+        return std::nullopt;
+    if (p_variantName.empty())
+        return it->second.enabled;
+    auto v = it->second.variants.find(p_variantName);
+    if (v == it->second.variants.end())
+        return std::nullopt;
+    return v->second;
+}
+
+std::uint32_t SharedMetricsSegment::cacheSlot(const std::string& p_toggleName, const std::string& p_variantName) {
+    std::lock_guard<std::mutex> lk(_cacheMutex);
+
+    // Another thread may have cached it while this one waited:
+    auto cache = std::atomic_load_explicit(&_slotCache, std::memory_order_acquire);
+    if (auto slot = cachedSlot(*cache, p_toggleName, p_variantName))
+        return *slot;
+
+    const std::int64_t found = findOrAllocateSlot(p_toggleName, p_variantName);
+    const std::uint32_t slot = found < 0 ? noSlot : static_cast<std::uint32_t>(found);
+
+    auto updated = std::make_shared<SlotCache>(*cache);
+    CachedSlots& entry = (*updated)[p_toggleName];
+    if (p_variantName.empty())
+        entry.enabled = slot;
+    else
+        entry.variants[p_variantName] = slot;
+    std::atomic_store_explicit(&_slotCache, std::shared_ptr<const SlotCache>(std::move(updated)),
+                               std::memory_order_release);
+    return slot;
+}
+
+SharedMetricsSegment::Counter* SharedMetricsSegment::counterFor(const std::string& p_toggleName,
+                                                                const std::string& p_variantName) {
+    if (_worker < 0)
+        return nullptr;
+
+    const auto cache = std::atomic_load_explicit(&_slotCache, std::memory_order_acquire);
+    const std::optional<std::uint32_t> cached = cachedSlot(*cache, p_toggleName, p_variantName);
+    const std::uint32_t slot = cached ? *cached : cacheSlot(p_toggleName, p_variantName);
+    if (slot == noSlot)
+        return nullptr;
+    return &counters(static_cast<std::uint32_t>(_worker))[slot];
+}
+
+void SharedMetricsSegment::addEnableMetric(const std::string& p_toggleName, bool p_isYes) {
+    Counter* counter = counterFor(p_toggleName, std::string());
+    if (!counter) {
+        _header->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    (p_isYes ? counter->yes : counter->no).fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedMetricsSegment::addVariantMetric(const std::string& p_toggleName, bool p_isYes,
+                                            const std::string& p_variantName) {
+    addEnableMetric(p_toggleName, p_isYes);
+    if (p_variantName.empty())
+        return;
+    Counter* counter = counterFor(p_toggleName, p_variantName);
+    if (!counter) {
+        _header->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    counter->yes.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricList SharedMetricsSegment::drain(std::int64_t& p_startMs) {
+    MetricList list;
+    Slot* table = slots();
+    const std::uint32_t count = std::min(_header->slotCount.load(std::memory_order_acquire), _header->maxSlots);
+
+    for (std::uint32_t s = 0; s < count; ++s) {
+        if (table[s].state.load(std::memory_order_acquire) != slotReady)
+            continue;
+
+        std::uint64_t yes = 0;
+        std::uint64_t no = 0;
+        for (std::uint32_t w = 0; w < _header->maxWorkers; ++w) {
+            Counter& c = counters(w)[s];
+            yes += c.yes.exchange(0, std::memory_order_relaxed);
+            no += c.no.exchange(0, std::memory_order_relaxed);
+        }
+
+        if (table[s].variantName[0] == '\0') {
+            if (yes || no)
+                list.addCounts(table[s].toggleName, static_cast<unsigned int>(yes), static_cast<unsigned int>(no));
+        } else if (yes) {
+            list.addVariantCount(table[s].toggleName, table[s].variantName, static_cast<unsigned int>(yes));
+        }
+    }
+
+    p_startMs = _header->windowStartMs.exchange(nowMs(), std::memory_order_acq_rel);
+    return list;
+}
+
+} // namespace unleash
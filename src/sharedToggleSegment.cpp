@@ -0,0 +1,229 @@
+#include "unleash/Store/sharedToggleSegment.hpp"
+#include "internal/binaryCodec.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace unleash {
+
+namespace {
+
+constexpr std::uint32_t segmentMagic = 0x55534753; // "USGS"
+constexpr std::uint32_t segmentLayoutVersion = 1;
+// A reader retries that many times when it races with two consecutive publishes before giving up:
+constexpr int maxReadAttempts = 64;
+
+std::string shmName(const std::string& p_name) {
+    return (!p_name.empty() && p_name.front() == '/') ? p_name : "/" + p_name;
+}
+
+} // namespace
+
+struct SharedToggleSegment::Header {
+    std::uint32_t magic;
+    std::uint32_t layoutVersion;
+    std::uint64_t capacity;
+    std::atomic<std::uint64_t> generation;
+    std::atomic<std::uint32_t> active;
+    std::atomic<std::uint64_t> sequence[2];
+    std::atomic<std::uint64_t> length[2];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared segment requires address-free atomics");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "shared segment requires address-free atomics");
+
+SharedToggleSegment::SharedToggleSegment(void* p_mapping, std::size_t p_mappingSize, bool p_publisher)
+    : _mapping(p_mapping), _mappingSize(p_mappingSize), _header(static_cast<Header*>(p_mapping)),
+      _publisher(p_publisher) {}
+
+#if defined(_WIN32)
+
+std::shared_ptr<SharedToggleSegment> SharedToggleSegment::create(const std::string&, std::size_t) {
+    return nullptr;
+}
+
+std::shared_ptr<SharedToggleSegment> SharedToggleSegment::open(const std::string&) {
+    return nullptr;
+}
+
+bool SharedToggleSegment::remove(const std::string&) {
+    return false;
+}
+
+SharedToggleSegment::~SharedToggleSegment() = default;
+
+#else
+
+std::shared_ptr<SharedToggleSegment> SharedToggleSegment::create(const std::string& p_name,
+                                                                 std::size_t p_capacityBytes) {
+    if (p_capacityBytes == 0)
+        return nullptr;
+
+    const std::string name = shmName(p_name);
+    const std::size_t mappingSize = sizeof(Header) + 2 * p_capacityBytes;
+
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    const bool fresh = static_cast<std::size_t>(st.st_size) != mappingSize;
+    if (fresh && ::ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* mapping = ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    auto* header = static_cast<Header*>(mapping);
+    // A restarted publisher keeps a compatible segment so that readers holding it stay valid:
+    if (fresh || header->magic != segmentMagic || header->layoutVersion != segmentLayoutVersion ||
+        header->capacity != p_capacityBytes) {
+        header = new (mapping) Header{};
+        header->capacity = p_capacityBytes;
+        header->layoutVersion = segmentLayoutVersion;
+        header->generation.store(0, std::memory_order_relaxed);
+        header->active.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < 2; ++i) {
+            header->sequence[i].store(0, std::memory_order_relaxed);
+            header->length[i].store(0, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = segmentMagic;
+    }
+
+    return std::shared_ptr<SharedToggleSegment>(new SharedToggleSegment(mapping, mappingSize, true));
+}
+
+std::shared_ptr<SharedToggleSegment> SharedToggleSegment::open(const std::string& p_name) {
+    const std::string name = shmName(p_name);
+
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return nullptr;
+    }
+    const auto mappingSize = static_cast<std::size_t>(st.st_size);
+
+    void* mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    const auto* header = static_cast<const Header*>(mapping);
+    if (header->magic != segmentMagic || header->layoutVersion != segmentLayoutVersion ||
+        sizeof(Header) + 2 * header->capacity != mappingSize) {
+        ::munmap(mapping, mappingSize);
+        return nullptr;
+    }
+
+    return std::shared_ptr<SharedToggleSegment>(new SharedToggleSegment(mapping, mappingSize, false));
+}
+
+bool SharedToggleSegment::remove(const std::string& p_name) {
+    return ::shm_unlink(shmName(p_name).c_str()) == 0;
+}
+
+SharedToggleSegment::~SharedToggleSegment() {
+    if (_mapping)
+        ::munmap(_mapping, _mappingSize);
+}
+
+#endif
+
+bool SharedToggleSegment::isPublisher() const noexcept {
+    return _publisher;
+}
+
+std::size_t SharedToggleSegment::capacity() const noexcept {
+    return static_cast<std::size_t>(_header->capacity);
+}
+
+std::uint64_t SharedToggleSegment::generation() const noexcept {
+    return _header->generation.load(std::memory_order_acquire);
+}
+
+char* SharedToggleSegment::buffer(std::uint32_t p_index) const noexcept {
+    return static_cast<char*>(_mapping) + sizeof(Header) + p_index * _header->capacity;
+}
+
+bool SharedToggleSegment::publish(const ToggleSet& p_toggles) {
+    if (!_publisher)
+        return false;
+
+    const std::vector<char> encoded = BinaryCodec::encodeToggleSet(p_toggles);
+    if (encoded.size() > capacity())
+        return false;
+
+    std::lock_guard<std::mutex> lk(_publishMutex);
+    const std::uint32_t target = 1 - _header->active.load(std::memory_order_relaxed);
+
+    // Odd sequence: readers racing on this buffer will retry.
+    const std::uint64_t seq = _header->sequence[target].load(std::memory_order_relaxed);
+    _header->sequence[target].store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(buffer(target), encoded.data(), encoded.size());
+    _header->length[target].store(encoded.size(), std::memory_order_relaxed);
+
+    _header->sequence[target].store(seq + 2, std::memory_order_release);
+    _header->active.store(target, std::memory_order_release);
+    _header->generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+std::optional<SharedToggleSegment::Snapshot> SharedToggleSegment::read() const {
+    std::vector<char> copy;
+
+    for (int attempt = 0; attempt < maxReadAttempts; ++attempt) {
+        const std::uint64_t gen = _header->generation.load(std::memory_order_acquire);
+        if (gen == 0)
+            return std::nullopt;
+
+        const std::uint32_t index = _header->active.load(std::memory_order_acquire);
+        const std::uint64_t seqBefore = _header->sequence[index].load(std::memory_order_acquire);
+        if (seqBefore & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::uint64_t length = _header->length[index].load(std::memory_order_relaxed);
+        if (length > _header->capacity)
+            continue;
+
+        copy.resize(static_cast<std::size_t>(length));
+        std::memcpy(copy.data(), buffer(index), copy.size());
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_header->sequence[index].load(std::memory_order_relaxed) != seqBefore)
+            continue;
+
+        auto decoded = BinaryCodec::decodeToggleSet(copy.data(), copy.size());
+        if (!decoded.has_value())
+            return std::nullopt;
+        return Snapshot{std::move(decoded.value()), gen};
+    }
+    return std::nullopt;
+}
+
+} // namespace unleash
@@ -1,6 +1,7 @@
 #include "unleash/Store/storageProvider.hpp"
 
 #include "internal/jsonCodec.hpp"
+#include "unleash/Utils/utils.hpp"
 
 #include <algorithm>
 #include <cctype>
@@ -29,17 +30,12 @@ FileStorageProvider::FileStorageProvider(std::string appName, std::string backup
 }
 
 const std::optional<ToggleSet> FileStorageProvider::get() {
-    std::ifstream in(_filePath, std::ios::binary);
-    if (!in.is_open()) {
+    const auto content = readContent();
+    if (!content.has_value()) {
         return std::nullopt;
     }
 
-    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-    if (content.empty() || isWhitespaceOnly(content)) {
-        return std::nullopt;
-    }
-
-    auto decoded = JsonCodec::decodeClientFeaturesResponse(content);
+    auto decoded = JsonCodec::decodeClientFeaturesResponse(*content);
     if (!decoded.has_value()) {
         return std::nullopt;
     }
@@ -47,6 +43,23 @@ const std::optional<ToggleSet> FileStorageProvider::get() {
 }
 
 void FileStorageProvider::save(const ToggleSet& t) {
+    writeContent(JsonCodec::encodeClientFeaturesResponse(t));
+}
+
+std::optional<std::string> FileStorageProvider::readContent() const {
+    std::ifstream in(_filePath, std::ios::binary);
+    if (!in.is_open()) {
+        return std::nullopt;
+    }
+
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (content.empty() || isWhitespaceOnly(content)) {
+        return std::nullopt;
+    }
+    return content;
+}
+
+void FileStorageProvider::writeContent(const std::string& p_content) {
     std::error_code ec;
     const std::filesystem::path path(_filePath);
 
@@ -57,13 +70,30 @@ void FileStorageProvider::save(const ToggleSet& t) {
         }
     }
 
-    std::ofstream out(_filePath, std::ios::binary | std::ios::trunc);
-    if (!out.is_open()) {
-        return;
+    const std::filesystem::path tmpPath(_filePath + ".tmp-" + utils::uuidv4Generator());
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return;
+        }
+
+        out << p_content;
+        out.flush();
+        if (!out) {
+            out.close();
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
     }
+}
 
-    out << JsonCodec::encodeClientFeaturesResponse(t);
-    out.flush();
+const std::string& FileStorageProvider::filePath() const {
+    return _filePath;
 }
 
 std::string FileStorageProvider::safeName(std::string s) {
@@ -3,7 +3,7 @@
 namespace unleash {
 
 Toggle::Toggle(std::string p_name, bool p_enabled, bool p_impressionData, Variant p_variant)
-    : _name(std::move(p_name)), _enabled(p_enabled), _impressionData(p_impressionData), _variant(std::move(p_variant))
+    : _name(std::move(p_name)), _enabled(p_enabled), _variant(std::move(p_variant)), _impressionData(p_impressionData)
 
 {}
 
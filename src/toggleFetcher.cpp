@@ -1,21 +1,34 @@
 #include "unleash/Fetcher/toggleFetcher.hpp"
 #include "unleash/Utils/utils.hpp"
+#include "internal/forkSupport.hpp"
 #include "internal/jsonCodec.hpp"
 #include <cctype>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <thread>
 
 namespace unleash {
 
-ToggleFetcher::ToggleFetcher(const ClientConfig& p_config) {
+ToggleFetcher::ToggleFetcher(const ClientConfig& p_config)
+    : _endpoints(p_config.urls()), _hedgePercentile(p_config.fetchHedgePercentile()),
+      _hedgeInitialDelay(p_config.fetchHedgeInitialDelay()) {
     makeFrontendRequest(p_config);
 }
 
+ToggleFetcher::~ToggleFetcher() {
+    stopHedgeThread();
+}
+
 void ToggleFetcher::makeFrontendRequest(const ClientConfig& p_config) {
     _baseUrl = p_config.url();
     _httpRequest.url = _baseUrl;
     _httpRequest.usePOSTrequests = p_config.usePostRequests();
-    _httpRequest.timeoutMs = static_cast<long>(p_config.timeOutQueryMS().count());
+    _timeout = p_config.timeOutQueryMS();
+    _httpRequest.timeoutMs = static_cast<long>(_timeout.count());
+    _httpRequest.unixSocketPath = p_config.unixSocketPath();
     // Fill headers similar to JS parseHeaders
     _httpRequest.headers.clear();
     _httpRequest.headers["accept"] = "application/json";
@@ -63,107 +76,374 @@ std::string urlEncodeContext(std::string_view value) {
     return out;
 }
 
-std::string buildContextQuery(const Context& ctx) {
-    std::string query;
-    query.reserve(256);
+void addQueryParam(std::string& query, std::string_view k, std::string_view v) {
+    if (v.empty())
+        return;
+    const char sep = query.empty() ? '?' : '&';
+    query.push_back(sep);
+    query.append(urlEncodeContext(k));
+    query.push_back('=');
+    query.append(urlEncodeContext(v));
+}
 
-    auto add = [&](const std::string& k, const std::string& v) {
-        if (v.empty())
-            return;
-        const char sep = query.empty() ? '?' : '&';
-        query.push_back(sep);
-        query.append(urlEncodeContext(k));
-        query.push_back('=');
-        query.append(urlEncodeContext(v));
-    };
-
-    add("appName", ctx.getAppName());
-    add("sessionId", ctx.getSessionId());
+// Fixed for the lifetime of a client: encoded once.
+std::string buildStaticContextQuery(const Context& ctx) {
+    std::string query;
+    addQueryParam(query, "appName", ctx.getAppName());
+    addQueryParam(query, "sessionId", ctx.getSessionId());
     if (ctx.getEnvironment())
-        add("environment", *ctx.getEnvironment());
+        addQueryParam(query, "environment", *ctx.getEnvironment());
+    return query;
+}
+
+// Appended to the static part, which always holds appName: every parameter is joined with '&'.
+void appendMutableContextQuery(const Context& ctx, std::string& query) {
     if (ctx.getUserId())
-        add("userId", *ctx.getUserId());
+        addQueryParam(query, "userId", *ctx.getUserId());
     if (ctx.getRemoteAddress())
-        add("remoteAddress", *ctx.getRemoteAddress());
+        addQueryParam(query, "remoteAddress", *ctx.getRemoteAddress());
     if (ctx.getCurrentTime())
-        add("currentTime", *ctx.getCurrentTime());
+        addQueryParam(query, "currentTime", *ctx.getCurrentTime());
 
     for (const auto& [k, v] : ctx.getProperties()) {
         if (k.empty() || v.empty())
             continue;
         // Encode custom properties using properties.<key>
-        add("properties[" + k + "]", v);
+        addQueryParam(query, "properties[" + k + "]", v);
+    }
+}
+
+// delay-seconds, or an IMF-fixdate such as "Wed, 21 Oct 2015 07:28:00 GMT".
+std::optional<utils::mSeconds> parseRetryAfter(const std::string& value) {
+    if (!value.empty() && std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        if (value.size() > 9)
+            return std::nullopt;
+        return std::chrono::duration_cast<utils::mSeconds>(utils::seconds{std::stol(value)});
     }
 
-    return query;
+    std::tm tm{};
+    std::istringstream iss(value);
+    iss >> std::get_time(&tm, "%a, %d %b %Y %H:%M:%S");
+    if (iss.fail())
+        return std::nullopt;
+#if defined(_WIN32)
+    const std::time_t at = _mkgmtime(&tm);
+#else
+    const std::time_t at = timegm(&tm);
+#endif
+    const auto delay = std::chrono::system_clock::from_time_t(at) - std::chrono::system_clock::now();
+    return std::max(utils::mSeconds{0}, std::chrono::duration_cast<utils::mSeconds>(delay));
+}
+
+std::optional<utils::mSeconds> retryAfterOf(const HttpResponse& response) {
+    for (const char* header : {"retry-after", "ratelimit-reset"}) {
+        auto it = response.headers.find(header);
+        if (it != response.headers.end()) {
+            if (auto delay = parseRetryAfter(it->second))
+                return delay;
+        }
+    }
+    return std::nullopt;
+}
+
+// A response from the server, as opposed to a transport failure.
+bool answered(const std::unique_ptr<IComResponse>& resp) {
+    auto httpResponse = dynamic_cast<const HttpResponse*>(resp.get());
+    return httpResponse && httpResponse->status > 0;
+}
+
+bool sameStaticContext(const Context& a, const Context& b) {
+    return a.getAppName() == b.getAppName() && a.getSessionId() == b.getSessionId() &&
+           a.getEnvironment() == b.getEnvironment();
 }
 
 } // namespace
 
-ToggleFetcher::FetchResult ToggleFetcher::fetch(const Context& p_ctx) {
+void ToggleFetcher::encodeContext(const Context& p_ctx) {
+    // The fingerprint only rules out a change cheaply: on a match, the fields of the encoded context decide.
+    const auto mutableKey = p_ctx.fingerprint();
+    const bool sameStatic = _encodedContext && sameStaticContext(*_encodedContext, p_ctx);
+    if (sameStatic && _mutableKey == mutableKey && _encodedContext->getMutableContext() == p_ctx.getMutableContext())
+        return;
+
     if (_httpRequest.usePOSTrequests) {
         _httpRequest.body = JsonCodec::encodeContextRequestBody(p_ctx);
     } else {
-        _httpRequest.body.clear();
+        if (!sameStatic)
+            _staticQuery = buildStaticContextQuery(p_ctx);
+        _httpRequest.url = _baseUrl;
+        _httpRequest.url += _staticQuery;
+        appendMutableContextQuery(p_ctx, _httpRequest.url);
+    }
+    _encodedContext = p_ctx;
+    _mutableKey = mutableKey;
+}
+
+void ToggleFetcher::useEndpoint(std::size_t p_index) {
+    if (p_index == _endpointIndex)
+        return;
+    _endpointIndex = p_index;
+    _baseUrl = _endpoints.stats(p_index).url;
+    if (_httpRequest.usePOSTrequests)
         _httpRequest.url = _baseUrl;
-        _httpRequest.url += buildContextQuery(p_ctx);
+    else
+        _mutableKey.reset();
+}
+
+void ToggleFetcher::interrupt() {
+    {
+        std::lock_guard<std::mutex> lk(_raceMutex);
+        if (_raceCaller && _raceCaller->load(std::memory_order_acquire)) {
+            _primaryCancel.store(true, std::memory_order_release);
+            _hedgeCancel.store(true, std::memory_order_release);
+        }
     }
-    auto resp = _httpClient.request(_httpRequest);
+    _raceCv.notify_all();
+    _httpClient.interrupt();
+    _hedgeClient.interrupt();
+}
+
+ToggleFetcher::FetchResult ToggleFetcher::fetch(const Context& p_ctx, IComClient::CancelToken* p_cancel) {
+    std::uint64_t tried = 0;
+    auto next = _endpoints.pick(tried);
+    for (;;) {
+        if (next)
+            useEndpoint(*next);
+
+        auto result = fetchOnce(p_ctx, p_cancel, tried | (std::uint64_t{1} << _endpointIndex));
+        tried |= (std::uint64_t{1} << _endpointIndex) | (std::uint64_t{1} << result.endpoint);
+        // Aborted: says nothing about the endpoint.
+        if ((p_cancel && p_cancel->load(std::memory_order_acquire)) || _endpoints.size() == 0)
+            return result;
+
+        const bool ok = result.status == utils::httpStatusNoUpdate ||
+                        (result.status >= utils::httpStatusOkLower && result.status < utils::httpStatusOkUpper);
+        if (ok) {
+            _endpoints.onSuccess(result.endpoint, result.latency);
+            _latencies.add(result.latency);
+        } else if (result.status <= 0 || result.status >= 500) {
+            _endpoints.onFailure(result.endpoint);
+        }
+
+        // Only transport errors (no HTTP status) fail over within this fetch:
+        if (result.status > 0 || !(next = _endpoints.pick(tried)))
+            return result;
+    }
+}
+
+bool ToggleFetcher::warmUp(IComClient::CancelToken* p_cancel) {
+    HttpRequest request = _httpRequest;
+    request.url = _baseUrl;
+    return _httpClient.warmUp(request, p_cancel);
+}
+
+std::optional<utils::mSeconds> ToggleFetcher::hedgeDelay() const {
+    if (!(_hedgePercentile > 0.0))
+        return std::nullopt;
+    auto delay = _latencies.percentile(_hedgePercentile);
+    if (!delay) {
+        if (_hedgeInitialDelay.count() <= 0)
+            return std::nullopt;
+        delay = _hedgeInitialDelay;
+    }
+    // A hedge fired after the timeout would never run.
+    if (_timeout.count() > 0 && *delay >= _timeout)
+        return std::nullopt;
+    return delay;
+}
+
+std::unique_ptr<IComResponse> ToggleFetcher::hedgedRequest(utils::mSeconds p_delay, IComClient::CancelToken* p_cancel,
+                                                           std::uint64_t p_tried, FetchResult& p_result) {
+    using Clock = EndpointSelector::Clock;
+
+    // To an alternate endpoint when there is one, else to the same one over another connection.
+    const std::size_t primaryIndex = _endpointIndex;
+    const auto started = Clock::now();
+    {
+        std::lock_guard<std::mutex> lk(_raceMutex);
+        if (!_hedgeThread.joinable()) {
+            _hedgeStop = false;
+            _hedgeThread = std::thread(&ToggleFetcher::hedgeLoop, this);
+        }
+        _raceCaller = p_cancel;
+        const bool cancelled = p_cancel && p_cancel->load(std::memory_order_acquire);
+        _primaryCancel.store(cancelled, std::memory_order_release);
+        _hedgeCancel.store(cancelled, std::memory_order_release);
+        _hedgeIndex = _endpoints.pick(p_tried).value_or(primaryIndex);
+        _hedgeDue = started + p_delay;
+        _primaryDone = false;
+        _winner = RaceWinner::None;
+        _hedgeResp.reset();
+        _raceArmed = true;
+    }
+    _raceCv.notify_all();
+
+    auto resp = _httpClient.request(_httpRequest, &_primaryCancel);
+    const auto primaryLatency = std::chrono::duration_cast<utils::mSeconds>(Clock::now() - started);
+    {
+        std::lock_guard<std::mutex> lk(_raceMutex);
+        _primaryDone = true;
+        // A failed primary leaves a hedge in flight running: its answer may still win.
+        if (_winner == RaceWinner::None && answered(resp)) {
+            _winner = RaceWinner::Primary;
+            _hedgeCancel.store(true, std::memory_order_release);
+        }
+    }
+    _raceCv.notify_all();
+    _hedgeClient.interrupt();
+
+    std::unique_lock<std::mutex> lk(_raceMutex);
+    _raceCv.wait(lk, [this] { return !_raceArmed; });
+    _raceCaller = nullptr;
+    if (_winner == RaceWinner::Hedge) {
+        // The primary endpoint took at least this long:
+        if (_hedgeIndex != primaryIndex && !(p_cancel && p_cancel->load(std::memory_order_acquire)))
+            _endpoints.onSuccess(primaryIndex, primaryLatency);
+        p_result.endpoint = _hedgeIndex;
+        p_result.latency = _hedgeLatency;
+        p_result.hedged = true;
+        return std::move(_hedgeResp);
+    }
+    p_result.latency = primaryLatency;
+    return resp;
+}
+
+void ToggleFetcher::hedgeLoop() {
+    using Clock = EndpointSelector::Clock;
+    std::unique_lock<std::mutex> lk(_raceMutex);
+    for (;;) {
+        _raceCv.wait(lk, [this] { return _hedgeStop || _raceArmed; });
+        if (!_raceArmed)
+            return; // stopped; an armed race is still wound up below
+
+        // Fire at the hedge delay unless the primary is done (or the fetch cancelled) by then.
+        if (!_raceCv.wait_until(lk, _hedgeDue, [this] { return _hedgeStop || _primaryDone || _hedgeCancel.load(); })) {
+            // The primary request only reads _httpRequest meanwhile.
+            _hedgeRequest = _httpRequest;
+            if (_hedgeIndex != _endpointIndex)
+                _hedgeRequest.url.replace(0, _baseUrl.size(), _endpoints.stats(_hedgeIndex).url);
+            lk.unlock();
+            const auto hedgeStarted = Clock::now();
+            auto resp = _hedgeClient.request(_hedgeRequest, &_hedgeCancel);
+            const auto hedgeLatency = std::chrono::duration_cast<utils::mSeconds>(Clock::now() - hedgeStarted);
+            lk.lock();
+            if (_winner == RaceWinner::None && answered(resp)) {
+                _winner = RaceWinner::Hedge;
+                _hedgeResp = std::move(resp);
+                _hedgeLatency = hedgeLatency;
+                _primaryCancel.store(true, std::memory_order_release);
+                lk.unlock();
+                _httpClient.interrupt();
+                lk.lock();
+            }
+        }
+        _raceArmed = false;
+        _raceCv.notify_all();
+    }
+}
+
+void ToggleFetcher::stopHedgeThread() {
+    {
+        std::lock_guard<std::mutex> lk(_raceMutex);
+        _hedgeStop = true;
+    }
+    _raceCv.notify_all();
+    if (_hedgeThread.joinable())
+        _hedgeThread.join();
+}
+
+void ToggleFetcher::prepareFork() {
+    _raceMutex.lock();
+}
+
+void ToggleFetcher::parentAfterFork() {
+    _raceMutex.unlock();
+}
+
+void ToggleFetcher::childAfterFork() {
+    forgetThread(_hedgeThread);
+    _raceMutex.unlock();
+    _httpClient.abandonConnections();
+    _hedgeClient.abandonConnections();
+}
+
+ToggleFetcher::FetchResult ToggleFetcher::fetchOnce(const Context& p_ctx, IComClient::CancelToken* p_cancel,
+                                                    std::uint64_t p_tried) {
+    encodeContext(p_ctx);
     FetchResult result;
+    result.endpoint = _endpointIndex;
 
-    if (!resp) {
-        result.error = "Error: null response from HttpClient";
-        return result;
+    std::unique_ptr<IComResponse> resp;
+    if (const auto delay = hedgeDelay()) {
+        resp = hedgedRequest(*delay, p_cancel, p_tried, result);
+    } else {
+        const auto started = EndpointSelector::Clock::now();
+        resp = _httpClient.request(_httpRequest, p_cancel);
+        result.latency =
+            std::chrono::duration_cast<utils::mSeconds>(EndpointSelector::Clock::now() - started);
+    }
+    decodeResponse(std::move(resp), result.hedged ? _hedgeClient : _httpClient, result);
+    return result;
+}
+
+void ToggleFetcher::decodeResponse(std::unique_ptr<IComResponse> p_resp, HttpClient& p_origin,
+                                   FetchResult& p_result) {
+    if (!p_resp) {
+        p_result.error = "Error: null response from HttpClient";
+        return;
     }
 
     // verify if it's an error response:
-    auto httpError = dynamic_cast<ErrorResponse*>(resp.get());
+    auto httpError = dynamic_cast<ErrorResponse*>(p_resp.get());
     if (httpError) {
         std::string errorMessage = "Request failed with code error <" +
                                    std::to_string(static_cast<int>(httpError->code())) + "> and message:\n " +
                                    httpError->message();
 
-        result.error = std::move(errorMessage);
-        return result;
+        p_result.error = std::move(errorMessage);
+        return;
     }
-    auto httpResponse = dynamic_cast<HttpResponse*>(resp.get());
+    auto httpResponse = dynamic_cast<HttpResponse*>(p_resp.get());
     if (!httpResponse) {
         std::string errorMessage = "Error: The resulting response is not of type: HttpResponse.";
-        result.error = std::move(errorMessage);
+        p_result.error = std::move(errorMessage);
 
-        return result;
+        return;
     }
     // Transport-level error...
     if (httpResponse->status == 0) {
-        result.status = httpResponse->status;
+        p_result.status = httpResponse->status;
         std::string errorMessage = "Transport error (status=0). Network failure / DNS / connection refused / etc.";
-        result.error = std::move(errorMessage);
-        return result;
+        p_result.error = std::move(errorMessage);
+        return;
     }
-    result.status = httpResponse->status;
+    p_result.status = httpResponse->status;
+    p_result.retryAfter = retryAfterOf(*httpResponse);
     // No modification case:
     if (httpResponse->status == utils::httpStatusNoUpdate) {
-        return result;
+        return;
     }
 
     if (httpResponse->status >= utils::httpStatusOkLower && httpResponse->status < utils::httpStatusOkUpper) {
         auto toggleSet = JsonCodec::decodeClientFeaturesResponse(httpResponse->body);
+        // The decoded body's buffer serves the next request of the client that received it:
+        p_origin.recycleBody(std::move(httpResponse->body));
         if (!toggleSet.has_value()) {
-            result.error = "Failed to decode toggles JSON: " + toggleSet.error();
-            return result;
+            p_result.error = "Failed to decode toggles JSON: " + toggleSet.error();
+            return;
         }
         if (toggleSet->size()) {
-            result.toggles = std::move(toggleSet.value());
+            p_result.toggles = std::move(toggleSet.value());
         }
         auto it = httpResponse->headers.find("etag");
         if (it != httpResponse->headers.end() && !it->second.empty()) {
             _etag = it->second;
             _httpRequest.headers["if-none-match"] = _etag;
         }
-        return result;
+        return;
     }
-    result.error = "Error: " + httpResponse->errorMessage;
-    return result;
+    p_result.error = "Error: " + httpResponse->errorMessage;
+    return;
 }
 
 } // namespace unleash
@@ -1,24 +1,84 @@
-#include "unleash/Client/unleashClient.hpp"
+#include "internal/unleashClientImpl.hpp"
+#include "internal/forkSupport.hpp"
 #include "unleash/Utils/utils.hpp"
+#include "unleash/Store/sharedToggleSegment.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
 #if defined(_WIN32)
 #include <windows.h>
 #else
+#include <pthread.h>
 #include <unistd.h>
 #endif
 
 namespace unleash {
 
-UnleashClient::UnleashClient(ClientConfig p_config, Context p_ctx)
-    : _config(std::move(p_config)), _context(std::move(p_ctx)), _metricStore(_config), _metricSender(_config),
-      _eventHandler(std::make_shared<EventHandler>()), _toggleFetcher(_config) {
+namespace {
+
+// Live clients, walked by the fork handlers. The mutex is held across fork() so the list cannot change meanwhile.
+std::mutex& forkRegistryMutex() {
+    static std::mutex m;
+    return m;
+}
+
+std::vector<UnleashClient::Impl*>& forkRegistry() {
+    static std::vector<UnleashClient::Impl*> clients;
+    return clients;
+}
+
+// The fetch breaker counts whole fetches, which fail only once failover has run out of endpoints (single endpoints
+// are skipped by the EndpointSelector cooldown): with several urls, it is labelled with all of them.
+std::string fetchCircuitLabel(const std::vector<std::string>& p_urls) {
+    std::string label;
+    for (const auto& url : p_urls) {
+        if (!label.empty())
+            label += ", ";
+        label += url;
+    }
+    return label;
+}
+
+} // namespace
+
+UnleashClient::Impl::Impl(ClientConfig p_config, Context p_ctx)
+    : _config(std::move(p_config)), _context(std::make_shared<const Context>(std::move(p_ctx))),
+      _metricStore(_config), _impressionSampler(_config), _pollBackoff(_config),
+      _fetchBreaker(fetchCircuitLabel(_config.urls()), _config.circuitBreakerThreshold(),
+                    _config.circuitBreakerOpenDuration()),
+      _metricsBreaker(_config.url() + std::string(utils::metricsExtansion), _config.circuitBreakerThreshold(),
+                      _config.circuitBreakerOpenDuration()),
+      _metricSender(_config), _toggleFetcher(_config),
+      _eventHandler(std::make_shared<EventHandler>(_config.eventQueueCapacity(), _config.eventOverflowPolicy(),
+                                                   _config.eventBlockTimeout(), _config.scheduler())) {
+    _contextFingerprint = _context->fingerprint();
+    // Connects while the backup loads:
+    startWarmUp();
     this->initializeToggleCache();
+    registerForkHandlers();
+
+    auto segment = _config.sharedToggleSegment();
+    if (segment && !segment->isPublisher()) {
+        _flagStore.attach(segment, [this] {
+            if (!_ready.exchange(true, std::memory_order_acq_rel)) {
+                _eventHandler->emitReady();
+            }
+            _eventHandler->emitUpdate();
+        });
+    }
 }
 
-UnleashClient::~UnleashClient() {
+UnleashClient::Impl::~Impl() {
+    {
+        std::lock_guard<std::mutex> lk(forkRegistryMutex());
+        auto& clients = forkRegistry();
+        clients.erase(std::remove(clients.begin(), clients.end(), this), clients.end());
+    }
     stop();
+    abortWarmUps();
 }
 
-void UnleashClient::start() {
+void UnleashClient::Impl::start() {
 
     if (_running.exchange(true, std::memory_order_acq_rel)) {
         return;
@@ -28,40 +88,226 @@ void UnleashClient::start() {
         _eventHandler->emitReady();
         _ready.store(true, std::memory_order_release);
     }
-    _exitThreads.store(false, std::memory_order_release);
-
-    _eventHandler->start();
-
-    _mSendingThread = std::thread(&UnleashClient::metricSendingLoop, this);
-    _fPollingThread = std::thread(&UnleashClient::featurePollingLoop, this);
+    startThreads();
 
     _running.store(true, std::memory_order_release);
 }
 
-void UnleashClient::stop() {
+void UnleashClient::Impl::stop() {
     if (!_running.exchange(false, std::memory_order_acq_rel)) {
         return; // not running
     }
 
+    stopThreads(true);
+
+    _running.store(false, std::memory_order_release);
+}
+
+void UnleashClient::Impl::startThreads() {
+    _exitThreads.store(false, std::memory_order_release);
+    _cancel.store(false, std::memory_order_release);
+
+    _eventHandler->start();
+    // A segment reader picks up the latest published snapshot right away, with its events (see the attach() callback):
+    _flagStore.refresh();
+
+    // Providers fed by another process push their snapshots directly:
+    _config.storageProvider()->watch([this](ToggleSet p_toggles) { applyToggles(std::move(p_toggles)); });
+
+    _taskGuard.open();
+    if (_config.isMetricsEnabled()) {
+        {
+            std::lock_guard<std::mutex> lk(_mutexMetrics);
+            _metricsScheduler = backgroundScheduler();
+        }
+        const auto initialDelay = _config.metricsIntervalInitial();
+        scheduleMetrics(initialDelay.count() > 0 ? initialDelay : _config.metricsInterval());
+    }
+    if (_config.isRefreshEnabled() || followsSegment()) {
+        {
+            std::lock_guard<std::mutex> lk(_mutexPolling);
+            _pollScheduler = backgroundScheduler();
+        }
+        if (_config.isRefreshEnabled())
+            schedulePoll(_pollBackoff.startupDelay());
+        if (followsSegment())
+            scheduleSegmentRefresh();
+    }
+}
+
+void UnleashClient::Impl::stopThreads(bool p_flushMetrics) {
     _exitThreads.store(true, std::memory_order_release);
+    _cancel.store(true, std::memory_order_release);
+    _fetchCancel.store(true, std::memory_order_release);
+    _toggleFetcher.interrupt();
+    _metricSender.interrupt();
+    abortWarmUps();
+
+    _config.storageProvider()->unwatch();
 
-    _cvMetrics.notify_all();
-    _cvPolling.notify_all();
+    std::shared_ptr<IScheduler> pollScheduler, metricsScheduler;
+    {
+        std::lock_guard<std::mutex> lk(_mutexPolling);
+        if (_pollScheduler) {
+            _pollScheduler->cancel(std::exchange(_pollTaskId, 0));
+            _pollScheduler->cancel(std::exchange(_segmentTaskId, 0));
+        }
+        pollScheduler = std::move(_pollScheduler);
+    }
+    {
+        std::lock_guard<std::mutex> lk(_mutexMetrics);
+        if (_metricsScheduler)
+            _metricsScheduler->cancel(std::exchange(_metricsTaskId, 0));
+        metricsScheduler = std::move(_metricsScheduler);
+    }
+    _taskGuard.close();
+    // No task of ours runs anymore: joins the threads of own schedulers, an application one is only released.
+    pollScheduler.reset();
+    metricsScheduler.reset();
 
-    if (_mSendingThread.joinable())
-        _mSendingThread.join();
-    if (_fPollingThread.joinable())
-        _fPollingThread.join();
+    if (p_flushMetrics)
+        flushMetricsOnStop();
 
     _eventHandler->stop();
+}
 
-    _running.store(false, std::memory_order_release);
+void UnleashClient::Impl::registerForkHandlers() {
+#if !defined(_WIN32)
+    static std::once_flag once;
+    std::call_once(once, [] {
+        ::pthread_atfork(&UnleashClient::Impl::prepareFork, &UnleashClient::Impl::parentAfterFork,
+                         &UnleashClient::Impl::childAfterFork);
+    });
+
+    std::lock_guard<std::mutex> lk(forkRegistryMutex());
+    forkRegistry().push_back(this);
+#endif
+}
+
+// Only the forking thread survives fork(). Before it, every client waits for its rounds in flight and takes the
+// locks the child needs, so that none is held by a thread that does not exist there; the parent then goes on as if
+// nothing happened, and the child re-arms the tasks and threads of started clients. Forking from an SDK callback or
+// while another thread starts or stops a client is not supported.
+void UnleashClient::Impl::prepareFork() {
+    forkRegistryMutex().lock();
+    // In two passes, as the callbacks of a client may evaluate flags of another one:
+    for (auto* client : forkRegistry())
+        client->quiesceForFork();
+    for (auto* client : forkRegistry())
+        client->lockForFork();
+}
+
+void UnleashClient::Impl::parentAfterFork() {
+    for (auto* client : forkRegistry()) {
+        client->_taskGuard.parentAfterFork();
+        client->_metricStore.parentAfterFork();
+        client->_eventHandler->parentAfterFork();
+        client->_config.storageProvider()->parentAfterFork();
+        client->_toggleFetcher.parentAfterFork();
+        client->releaseAfterFork();
+    }
+    forkRegistryMutex().unlock();
 }
 
-bool UnleashClient::isStoreReady() {
+void UnleashClient::Impl::childAfterFork() {
+    for (auto* client : forkRegistry()) {
+        client->_taskGuard.childAfterFork();
+        // Counts of the current window belong to the parent, which still reports them, and so does a stashed payload.
+        client->_metricStore.childAfterFork();
+        client->_unsentMetrics.reset();
+        // Kept connections are shared with the parent:
+        client->_toggleFetcher.childAfterFork();
+        client->_metricSender.abandonConnections();
+        client->_eventHandler->childAfterFork();
+        client->_config.storageProvider()->childAfterFork();
+        client->releaseAfterFork();
+        if (client->_running.load(std::memory_order_acquire))
+            client->rearmAfterFork();
+    }
+    forkRegistryMutex().unlock();
+}
+
+void UnleashClient::Impl::quiesceForFork() {
+    // A warm-up is only aborted, its thread would not survive; fetches and metrics sends run to completion.
+    abortWarmUps();
+    _pollRoundMutex.lock();
+    _metricsRoundMutex.lock();
+    // Before the client locks: snapshot deliveries and event callbacks may call into the client.
+    _config.storageProvider()->prepareFork();
+    _eventHandler->prepareFork();
+}
+
+void UnleashClient::Impl::lockForFork() {
+    _mutexPolling.lock();
+    _mutexMetrics.lock();
+    _toggleFetcher.prepareFork();
+    _flagStore.prepareFork();
+    _impressionSampler.prepareFork();
+    _metricStore.prepareFork();
+    _taskGuard.prepareFork();
+}
+
+// Common to both sides, once the components have released their own locks.
+void UnleashClient::Impl::releaseAfterFork() {
+    _impressionSampler.afterFork();
+    _flagStore.afterFork();
+    _mutexMetrics.unlock();
+    _mutexPolling.unlock();
+    _metricsRoundMutex.unlock();
+    _pollRoundMutex.unlock();
+}
+
+void UnleashClient::Impl::rearmAfterFork() {
+    // The schedulers of our own lost their threads: they are left alone, as neither using nor destroying them is safe
+    // anymore. An application scheduler is the application's to restore; tasks posted before the fork are skipped.
+    const bool ownSchedulers = !_config.scheduler();
+    bool poll = false, metrics = false;
+    {
+        std::lock_guard<std::mutex> lk(_mutexPolling);
+        _pollTaskId = 0;
+        _segmentTaskId = 0;
+        if ((poll = _pollScheduler != nullptr) && ownSchedulers) {
+            abandonAfterFork(_pollScheduler);
+            _pollScheduler = backgroundScheduler();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lk(_mutexMetrics);
+        _metricsTaskId = 0;
+        if ((metrics = _metricsScheduler != nullptr) && ownSchedulers) {
+            abandonAfterFork(_metricsScheduler);
+            _metricsScheduler = backgroundScheduler();
+        }
+    }
+    // A snapshot inherited from the parent is still fresh: the next fetch waits for the interval.
+    if (poll && _config.isRefreshEnabled())
+        schedulePoll(_ready.load(std::memory_order_acquire) ? utils::mSeconds{_config.refreshInterval()}
+                                                            : _pollBackoff.startupDelay());
+    if (poll && followsSegment())
+        scheduleSegmentRefresh();
+    if (metrics)
+        scheduleMetrics(_config.metricsInterval());
+}
+
+bool UnleashClient::Impl::isStoreReady() {
     return _flagStore.isReady();
 }
 
+bool UnleashClient::Impl::followsSegment() const {
+    auto segment = _config.sharedToggleSegment();
+    return segment && !segment->isPublisher();
+}
+
+void UnleashClient::Impl::scheduleSegmentRefresh() {
+    std::lock_guard<std::mutex> lk(_mutexPolling);
+    if (_exitThreads.load(std::memory_order_acquire) || !_pollScheduler)
+        return;
+    _segmentTaskId = _pollScheduler->postAfter(utils::sharedSegmentPollInterval, _taskGuard.wrap([this] {
+        _flagStore.refresh();
+        scheduleSegmentRefresh();
+    }));
+}
+
 // void UnleashClient::initializeToggleCache()
 // {
 //     bool hasStoredToggles = false;
@@ -90,7 +336,7 @@ bool UnleashClient::isStoreReady() {
 //     }
 // }
 
-void UnleashClient::initializeToggleCache() {
+void UnleashClient::Impl::initializeToggleCache() {
     auto bootstrap = _config.bootstrap();
     bool bootstrapValid = false;
     if (_config.bootstrapOverride() && bootstrap.has_value() && !bootstrap->getToggles().empty()) {
@@ -110,153 +356,280 @@ void UnleashClient::initializeToggleCache() {
     }
 }
 
-void UnleashClient::persistToggles(const ToggleSet& p_toggles) {
-    if (auto storage = _config.storageProvider()) {
-        storage->save(p_toggles);
+void UnleashClient::Impl::startWarmUp() {
+    if (!_config.preconnect())
+        return;
+    // Outcomes do not matter: the fetch and the send report errors.
+    if (_config.isRefreshEnabled()) {
+        _fetchWarmUp.pending.store(true, std::memory_order_release);
+        _fetchWarmUp.thread = std::thread([this] { _toggleFetcher.warmUp(&_fetchWarmUp.cancel); });
+    }
+    if (_config.isMetricsEnabled()) {
+        _metricsWarmUp.pending.store(true, std::memory_order_release);
+        _metricsWarmUp.thread = std::thread([this] { _metricSender.warmUp(&_metricsWarmUp.cancel); });
     }
 }
 
-void UnleashClient::featurePollingLoop() {
-    if (!_config.isRefreshEnabled())
+void UnleashClient::Impl::finishWarmUp(WarmUp& p_warmUp, bool p_abort) {
+    if (!p_warmUp.pending.load(std::memory_order_acquire))
+        return;
+    // Before the lock, which a task may hold while it joins the same warm-up:
+    if (p_abort) {
+        p_warmUp.cancel.store(true, std::memory_order_release);
+        _toggleFetcher.interrupt();
+        _metricSender.interrupt();
+    }
+    std::lock_guard<std::mutex> lk(p_warmUp.mutex);
+    if (!p_warmUp.thread.joinable())
         return;
+    p_warmUp.thread.join();
+    p_warmUp.pending.store(false, std::memory_order_release);
+}
 
-    const auto interval = _config.refreshInterval();
+void UnleashClient::Impl::abortWarmUps() {
+    finishWarmUp(_fetchWarmUp, true);
+    finishWarmUp(_metricsWarmUp, true);
+}
 
-    // ---- Initial poll
-    {
-        Context snapshot = [&] {
-            std::lock_guard<std::mutex> lk(_mutexPolling);
-            return _context;
-        }();
-        singleFetchToggles(snapshot);
+void UnleashClient::Impl::persistToggles(const ToggleSet& p_toggles) {
+    if (auto storage = _config.storageProvider()) {
+        storage->save(p_toggles);
     }
+    auto segment = _config.sharedToggleSegment();
+    if (segment && segment->isPublisher()) {
+        segment->publish(p_toggles);
+    }
+}
 
-    while (!_exitThreads.load(std::memory_order_acquire)) {
-        Context snapshot = [&] {
-            std::unique_lock<std::mutex> lock(_mutexPolling);
-
-            _cvPolling.wait_for(lock, interval,
-                                [this] { return _exitThreads.load(std::memory_order_acquire) || _contextUpdated; });
+utils::mSeconds UnleashClient::Impl::singleFetchToggles() {
+    finishWarmUp(_fetchWarmUp);
 
-            if (_exitThreads.load(std::memory_order_acquire))
-                return _context;
+    // Open circuit: no call until the half-open probe is due.
+    CircuitBreaker::Transition transition;
+    if (!_fetchBreaker.tryAcquire(transition))
+        return std::max(_fetchBreaker.remainingOpen(), utils::mSeconds{1});
+    emitCircuitTransition(transition);
 
-            _contextUpdated = false;
-            return _context;
-        }();
+    auto [ctx, version] = beginFetch();
+    auto fetchResult = _toggleFetcher.fetch(*ctx, &_fetchCancel);
 
-        if (_exitThreads.load(std::memory_order_acquire))
-            break;
-        singleFetchToggles(snapshot);
+    // Superseded by updateContext() (the caller fetches again right away) or aborted by stop(): not an error.
+    if (contextVersion() != version) {
+        _fetchBreaker.release();
+        if (fetchResult.status >= utils::httpStatusOkLower && fetchResult.status < utils::httpStatusOkUpper)
+            _toggleFetcher.invalidateEtag(); // the next response must not be a 304 against a dropped body
+        return _config.refreshInterval();
+    }
+    if (fetchResult.error.has_value() && _fetchCancel.load(std::memory_order_acquire)) {
+        _fetchBreaker.release();
+        return _config.refreshInterval();
     }
-}
-
-void UnleashClient::singleFetchToggles(const Context& p_ctx) {
-    auto fetchResult = _toggleFetcher.fetch(p_ctx);
 
     if (fetchResult.error.has_value()) {
 
         // define a logging strategy here!
 
-        // emit onError(...)
-        _eventHandler->emitError(
-            EventHandler::ClientError{"Toggle fetch failed", std::move(fetchResult.error.value())});
+        // emit onError(...), or the circuit transition while it is not closed
+        emitCircuitTransition(_fetchBreaker.onFailure());
+        if (_fetchBreaker.state() == CircuitState::Closed)
+            _eventHandler->emitError(
+                EventHandler::ClientError{"Toggle fetch failed", std::move(fetchResult.error.value())});
 
         // update sdk status!!
         if (_sdkState == SdkState::Started || _sdkState == SdkState::Healthy) {
             _sdkState = SdkState::Error;
         }
 
-        return;
+        // Transport errors, 429 and 5xx alike: back off, at least for as long as the server asked.
+        return _pollBackoff.onFailure(fetchResult.retryAfter);
     }
+    const bool ok = fetchResult.status == 304 ||
+                    (fetchResult.status >= utils::httpStatusOkLower && fetchResult.status < utils::httpStatusOkUpper);
+    emitCircuitTransition(ok ? _fetchBreaker.onSuccess() : _fetchBreaker.onFailure());
     if (fetchResult.status == 304) {
         // Success but no update
-        return;
+        return _pollBackoff.onSuccess();
     }
     if ((fetchResult.status >= utils::httpStatusOkLower && fetchResult.status < utils::httpStatusOkUpper)) {
         if (fetchResult.toggles.has_value()) {
             persistToggles(fetchResult.toggles.value());
-
-            _flagStore.replace(std::make_shared<unleash::ToggleSet>(std::move(fetchResult.toggles.value())));
-
-            if (!_ready.exchange(true, std::memory_order_acq_rel)) {
-                _eventHandler->emitReady();
-            }
-            // emit UpdateEvent:
-            _eventHandler->emitUpdate();
+            applyToggles(std::move(fetchResult.toggles.value()));
         } else {
             // define a logging strategy here!
         }
+        return _pollBackoff.onSuccess();
+    }
+    // define a logging strategy here!
+    //  emit onError(...)
+    if (_fetchBreaker.state() == CircuitState::Closed)
+        _eventHandler->emitError(EventHandler::ClientError{
+            "Toggle fetch failed", fetchResult.error.value_or("HTTP status " + std::to_string(fetchResult.status))});
+    return _pollBackoff.onFailure(fetchResult.retryAfter);
+}
 
-    } else {
-        // define a logging strategy here!
-        //  emit onError(...)
-        _eventHandler->emitError(
-            EventHandler::ClientError{"Toggle fetch failed", std::move(fetchResult.error.value())});
+void UnleashClient::Impl::applyToggles(ToggleSet p_toggles) {
+    _flagStore.replace(std::make_shared<unleash::ToggleSet>(std::move(p_toggles)));
+
+    if (!_ready.exchange(true, std::memory_order_acq_rel)) {
+        _eventHandler->emitReady();
     }
+    // emit UpdateEvent:
+    _eventHandler->emitUpdate();
 }
 
-void UnleashClient::metricSendingLoop() {
-    if (!_config.isMetricsEnabled())
+std::shared_ptr<IScheduler> UnleashClient::Impl::backgroundScheduler() const {
+    auto scheduler = _config.scheduler();
+    return scheduler ? scheduler : std::make_shared<ThreadScheduler>();
+}
+
+void UnleashClient::Impl::schedulePoll(utils::mSeconds p_delay) {
+    std::lock_guard<std::mutex> lk(_mutexPolling);
+    if (_exitThreads.load(std::memory_order_acquire) || !_pollScheduler)
         return;
+    _pollTaskId = _pollScheduler->postAfter(p_delay, _taskGuard.wrap([this] { pollTask(); }));
+}
 
-    auto waitAndMaybeSend = [&](std::chrono::milliseconds timeout) -> bool {
-        std::unique_lock<std::mutex> lock(_mutexMetrics);
-        _cvMetrics.wait_for(lock, timeout, [this] { return _exitThreads.load(std::memory_order_acquire); });
+void UnleashClient::Impl::pollTask() {
+    {
+        std::lock_guard<std::mutex> lk(_mutexPolling);
+        _pollTaskId = 0;
+        _contextUpdated = false;
+    }
+    utils::mSeconds next;
+    {
+        std::lock_guard<std::mutex> round(_pollRoundMutex);
+        next = singleFetchToggles();
+    }
 
-        if (_exitThreads.load(std::memory_order_acquire))
-            return false;
+    // A context update that raced with the fetch triggers another round right away:
+    bool contextUpdated = false;
+    {
+        std::lock_guard<std::mutex> lk(_mutexPolling);
+        contextUpdated = _contextUpdated;
+    }
+    schedulePoll(contextUpdated ? _config.contextUpdateDebounce() : next);
+}
 
-        lock.unlock();
-        auto res = sendMetrics();
-        // handle response...
-        if (res.has_value()) {
-            if (res.value().error.has_value()) {
-                // Emit error signal:
-                _eventHandler->emitError(EventHandler::ClientError{"Metric sending failed", res.value().error.value()});
-            }
+void UnleashClient::Impl::scheduleMetrics(utils::mSeconds p_delay) {
+    std::lock_guard<std::mutex> lk(_mutexMetrics);
+    if (_exitThreads.load(std::memory_order_acquire) || !_metricsScheduler)
+        return;
+    _metricsTaskId = _metricsScheduler->postAfter(p_delay, _taskGuard.wrap([this] { metricsTask(); }));
+}
+
+void UnleashClient::Impl::metricsTask() {
+    {
+        std::lock_guard<std::mutex> lk(_mutexMetrics);
+        _metricsTaskId = 0;
+    }
+    {
+        std::lock_guard<std::mutex> round(_metricsRoundMutex);
+        sendMetricsAndReport();
+    }
+    scheduleMetrics(_config.metricsInterval());
+}
+
+void UnleashClient::Impl::sendMetricsAndReport() {
+    auto res = sendMetrics();
+    // handle response...
+    if (res.has_value()) {
+        if (res.value().error.has_value() && _metricsBreaker.state() == CircuitState::Closed) {
+            // Emit error signal:
+            _eventHandler->emitError(EventHandler::ClientError{"Metric sending failed", res.value().error.value()});
         }
-        return true;
-    };
+    }
+}
 
-    const auto initialDelay = _config.metricsIntervalInitial();
-    const auto interval = _config.metricsInterval();
+std::optional<MetricSender::MetricResult> UnleashClient::Impl::sendMetrics() {
+    finishWarmUp(_metricsWarmUp);
+    std::optional<MetricSender::MetricResult> result;
+    if (_unsentMetrics.has_value()) {
+        if (!acquireMetricsCall())
+            return result;
+        result = sendMetricsPayload(std::move(*std::exchange(_unsentMetrics, std::nullopt)), utils::mSeconds{0});
+        if (_unsentMetrics.has_value())
+            return result;
+    }
+    // Open circuit: the counts stay in the store until a call goes out.
+    if (!acquireMetricsCall())
+        return result;
+    auto jsonMetricsPayload = takeMetricsPayload();
+    if (!jsonMetricsPayload.has_value()) {
+        _metricsBreaker.release();
+        return result;
+    }
+    return sendMetricsPayload(std::move(jsonMetricsPayload.value()), utils::mSeconds{0});
+}
 
-    if (initialDelay.count() > 0) {
-        if (!waitAndMaybeSend(initialDelay))
-            return;
+std::optional<std::string> UnleashClient::Impl::takeMetricsPayload() {
+    // With a shared metrics segment the lease outlives a couple of intervals, so a dead sender is replaced quickly:
+    const auto lease = std::chrono::duration_cast<utils::mSeconds>(3 * _config.metricsInterval());
+    return _metricStore.takeJsonMetricsPayload(lease);
+}
+
+MetricSender::MetricResult UnleashClient::Impl::sendMetricsPayload(std::string p_payload, utils::mSeconds p_timeout) {
+    auto result = _metricSender.sendMetrics(p_payload, &_cancel, p_timeout);
+    if (result.error.has_value() && _cancel.load(std::memory_order_acquire)) {
+        // Aborted by stop(): keep the counts for the final flush.
+        _unsentMetrics = std::move(p_payload);
+        result.error.reset();
+        _metricsBreaker.release();
+    } else if (result.error.has_value()) {
+        emitCircuitTransition(_metricsBreaker.onFailure());
+    } else {
+        emitCircuitTransition(_metricsBreaker.onSuccess());
     }
+    return result;
+}
 
-    // Periodic phase
-    while (!_exitThreads.load(std::memory_order_acquire)) {
-        if (!waitAndMaybeSend(interval))
+void UnleashClient::Impl::flushMetricsOnStop() {
+    const auto deadline = _config.metricsFlushOnStop();
+    if (!_config.isMetricsEnabled() || deadline.count() <= 0)
+        return;
+
+    // The threads are joined: this is the only sender left, bounded by the deadline instead of the cancel token.
+    _cancel.store(false, std::memory_order_release);
+    std::vector<std::string> payloads;
+    if (_unsentMetrics.has_value())
+        payloads.push_back(std::move(*std::exchange(_unsentMetrics, std::nullopt)));
+    if (auto current = takeMetricsPayload())
+        payloads.push_back(std::move(*current));
+
+    const auto until = std::chrono::steady_clock::now() + deadline;
+    for (auto& payload : payloads) {
+        const auto left = std::chrono::duration_cast<utils::mSeconds>(until - std::chrono::steady_clock::now());
+        if (left.count() <= 0 || !acquireMetricsCall())
             break;
+        auto res = sendMetricsPayload(std::move(payload), left);
+        if (res.error.has_value() && _metricsBreaker.state() == CircuitState::Closed)
+            _eventHandler->emitError(EventHandler::ClientError{"Metric sending failed", res.error.value()});
     }
 }
 
-std::optional<MetricSender::MetricResult> UnleashClient::sendMetrics() {
-    if (_metricStore.empty()) {
-        _metricStore.reset();
-        return std::nullopt;
-    }
-    auto jsonMetricsPayload = _metricStore.toJsonMetricsPayload();
+bool UnleashClient::Impl::acquireMetricsCall() {
+    CircuitBreaker::Transition transition;
+    const bool allowed = _metricsBreaker.tryAcquire(transition);
+    emitCircuitTransition(transition);
+    return allowed;
+}
 
-    MetricSender::MetricResult res;
-    res = _metricSender.sendMetrics(jsonMetricsPayload.value());
-    _metricStore.reset();
-    return res;
+void UnleashClient::Impl::emitCircuitTransition(const CircuitBreaker::Transition& p_transition) {
+    if (p_transition.has_value())
+        _eventHandler->emitCircuitStateChange(*p_transition);
 }
 
-bool UnleashClient::isRunning() const noexcept {
+bool UnleashClient::Impl::isRunning() const noexcept {
     return _running.load(std::memory_order_acquire);
 }
 
-bool UnleashClient::isReady() const noexcept {
+bool UnleashClient::Impl::isReady() const noexcept {
+    // A segment reader does not wait for its next refresh task; the store's callback flips _ready.
+    _flagStore.refresh();
     return _ready.load(std::memory_order_acquire);
 }
 
-bool UnleashClient::isEnabled(const std::string& flagName) {
-    if (!this->isReady())
+bool UnleashClient::Impl::isEnabled(const std::string& flagName) {
+    if (!_ready.load(std::memory_order_acquire))
         return false;
     auto toggleSet = _flagStore.snapshot();
     if (!toggleSet || !toggleSet->contains(flagName))
@@ -264,22 +637,19 @@ bool UnleashClient::isEnabled(const std::string& flagName) {
     bool enabled = toggleSet->isEnabled(flagName);
     _metricStore.addEnableMetric(flagName, enabled);
     bool impression = toggleSet->impressionData(flagName);
-    if (this->_config.impressionDataAll() || impression) {
+    std::uint64_t suppressed = 0;
+    // Without a listener the sampler is not consulted, which would take a lock and consume its suppressed count:
+    if ((this->_config.impressionDataAll() || impression) && _eventHandler->wantsImpressions() &&
+        _impressionSampler.admit(flagName, enabled, std::string{}, suppressed)) {
         // Impression event emission
-        unleash::Context ctx;
-        {
-            std::lock_guard<std::mutex> lk(_mutexPolling);
-            ctx = _context;
-        }
-
-        _eventHandler->emitImpression(
-            unleash::EventHandler::ClientImpression{ctx, flagName, enabled, "isEnabled", impression});
+        _eventHandler->emitImpression(unleash::EventHandler::ClientImpression{contextSnapshot(), flagName, enabled,
+                                                                              "isEnabled", impression, "", suppressed});
     }
     return enabled;
 }
 
-Variant UnleashClient::getVariant(const std::string& flagName) {
-    if (!this->isReady())
+Variant UnleashClient::Impl::getVariant(const std::string& flagName) {
+    if (!_ready.load(std::memory_order_acquire))
         return Variant::disabledFactory();
     auto toggleSet = _flagStore.snapshot();
     if (!toggleSet || !toggleSet->contains(flagName))
@@ -288,21 +658,17 @@ Variant UnleashClient::getVariant(const std::string& flagName) {
     Variant variant = toggleSet->getVariant(flagName);
     _metricStore.addVariantMetric(flagName, enabled, variant.name());
     bool impression = toggleSet->impressionData(flagName);
-    if (this->_config.impressionDataAll() || toggleSet->impressionData(flagName)) {
+    std::uint64_t suppressed = 0;
+    if ((this->_config.impressionDataAll() || impression) && _eventHandler->wantsImpressions() &&
+        _impressionSampler.admit(flagName, enabled, variant.name(), suppressed)) {
         // Impression event emission
-        unleash::Context ctx;
-        {
-            std::lock_guard<std::mutex> lk(_mutexPolling);
-            ctx = _context;
-        }
-
-        _eventHandler->emitImpression(
-            unleash::EventHandler::ClientImpression{ctx, flagName, enabled, "getVariant", impression, variant.name()});
+        _eventHandler->emitImpression(unleash::EventHandler::ClientImpression{
+            contextSnapshot(), flagName, enabled, "getVariant", impression, variant.name(), suppressed});
     }
     return variant;
 }
 
-bool UnleashClient::impressionData(const std::string& flagName) const {
+bool UnleashClient::Impl::impressionData(const std::string& flagName) const {
     auto toggleSet = _flagStore.snapshot();
     if (!toggleSet)
         return false;
@@ -310,41 +676,167 @@ bool UnleashClient::impressionData(const std::string& flagName) const {
     return toggleSet->impressionData(flagName);
 }
 
-Context UnleashClient::context() const {
-    return _context;
+Context UnleashClient::Impl::context() const {
+    return *contextSnapshot();
 }
 
-void UnleashClient::updateContext(const MutableContext& p_mCtx) {
+std::shared_ptr<const Context> UnleashClient::Impl::contextSnapshot() const {
+    return std::atomic_load_explicit(&_context, std::memory_order_acquire);
+}
+
+std::pair<std::shared_ptr<const Context>, std::uint64_t> UnleashClient::Impl::beginFetch() {
+    std::lock_guard<std::mutex> lk(_mutexPolling);
+    // A fetch starting now is for the latest context (stop() keeps the token set):
+    if (!_exitThreads.load(std::memory_order_acquire))
+        _fetchCancel.store(false, std::memory_order_release);
+    return {contextSnapshot(), _contextVersion};
+}
+
+std::uint64_t UnleashClient::Impl::contextVersion() {
+    std::lock_guard<std::mutex> lk(_mutexPolling);
+    return _contextVersion;
+}
+
+EventStats UnleashClient::Impl::eventStats() const {
+    return _eventHandler->stats();
+}
+
+void UnleashClient::Impl::updateContext(const MutableContext& p_mCtx) {
+    const auto fingerprint = p_mCtx.fingerprint();
     {
+        // Readers keep the snapshot they loaded; writers are serialized by _mutexPolling.
         std::lock_guard<std::mutex> lk(_mutexPolling);
-        _context.updateMutableContext(p_mCtx);
+        // Same effective context: nothing to fetch. The fingerprint is only a pre-check, fields decide on a match.
+        if (fingerprint == _contextFingerprint && p_mCtx == _context->getMutableContext())
+            return;
+        auto updated = std::make_shared<Context>(*_context);
+        updated->updateMutableContext(p_mCtx);
+        std::atomic_store_explicit(&_context, std::shared_ptr<const Context>(std::move(updated)),
+                                   std::memory_order_release);
+        _contextFingerprint = fingerprint;
+        _lastContextUpdate = std::chrono::steady_clock::now();
+        ++_contextVersion;
         _contextUpdated = true;
+        // The in-flight fetch (if any) is for the previous context: abort it.
+        _fetchCancel.store(true, std::memory_order_release);
+
+        // Push the pending poll to the end of the debounce window; a running one reschedules itself when it sees
+        // _contextUpdated.
+        if (_pollScheduler && _pollTaskId != 0 && _pollScheduler->cancel(_pollTaskId))
+            _pollTaskId =
+                _pollScheduler->postAfter(_config.contextUpdateDebounce(), _taskGuard.wrap([this] { pollTask(); }));
     }
-    _cvPolling.notify_one();
+    _toggleFetcher.interrupt();
+}
+
+// ---- UnleashClient
+
+UnleashClient::UnleashClient(ClientConfig p_config, Context p_ctx)
+    : _impl(std::make_unique<Impl>(std::move(p_config), std::move(p_ctx))) {}
+
+UnleashClient::~UnleashClient() = default;
+
+void UnleashClient::start() {
+    _impl->start();
+}
+
+void UnleashClient::stop() {
+    _impl->stop();
+}
+
+bool UnleashClient::isRunning() const noexcept {
+    return _impl->isRunning();
+}
+
+bool UnleashClient::isReady() const noexcept {
+    return _impl->isReady();
+}
+
+bool UnleashClient::isEnabled(const std::string& flagName) {
+    return _impl->isEnabled(flagName);
+}
+
+Variant UnleashClient::getVariant(const std::string& flagName) {
+    return _impl->getVariant(flagName);
+}
+
+bool UnleashClient::impressionData(const std::string& flagName) const {
+    return _impl->impressionData(flagName);
+}
+
+Context UnleashClient::context() const {
+    return _impl->context();
+}
+
+void UnleashClient::updateContext(const MutableContext& p_mCtx) {
+    _impl->updateContext(p_mCtx);
+}
+
+ListenerToken UnleashClient::addInitListener(InitCallback cb) {
+    return _impl->eventHandler().addInitListener(std::move(cb));
+}
+
+ListenerToken UnleashClient::addErrorListener(ErrorCallback cb) {
+    return _impl->eventHandler().addErrorListener(std::move(cb));
+}
+
+ListenerToken UnleashClient::addReadyListener(ReadyCallback cb) {
+    return _impl->eventHandler().addReadyListener(std::move(cb));
+}
+
+ListenerToken UnleashClient::addUpdateListener(UpdateCallback cb) {
+    return _impl->eventHandler().addUpdateListener(std::move(cb));
+}
+
+ListenerToken UnleashClient::addImpressionListener(ImpressionCallback cb) {
+    return _impl->eventHandler().addImpressionListener(std::move(cb));
+}
+
+ListenerToken UnleashClient::addCircuitStateChangeListener(CircuitStateCallback cb) {
+    return _impl->eventHandler().addCircuitStateChangeListener(std::move(cb));
+}
+
+bool UnleashClient::removeListener(ListenerToken token) {
+    return _impl->eventHandler().removeListener(token);
+}
+
+EventStats UnleashClient::eventStats() const {
+    return _impl->eventStats();
+}
+
+UnleashClient& UnleashClient::onInit(InitCallback cb) {
+    _impl->eventHandler().onInit(cb);
+    return *this;
+}
+
+UnleashClient& UnleashClient::onError(ErrorCallback cb) {
+    _impl->eventHandler().onError(cb);
+    return *this;
 }
 
-UnleashClient& UnleashClient::onInit(EventHandler::InitCallback cb) {
-    _eventHandler->onInit(cb);
+UnleashClient& UnleashClient::onReady(ReadyCallback cb) {
+    _impl->eventHandler().onReady(cb);
     return *this;
 }
 
-UnleashClient& UnleashClient::onError(EventHandler::ErrorCallback cb) {
-    _eventHandler->onError(cb);
+UnleashClient& UnleashClient::onUpdate(UpdateCallback cb) {
+    _impl->eventHandler().onUpdate(cb);
     return *this;
 }
 
-UnleashClient& UnleashClient::onReady(EventHandler::ReadyCallback cb) {
-    _eventHandler->onReady(cb);
+UnleashClient& UnleashClient::onImpression(ImpressionCallback cb) {
+    _impl->eventHandler().onImpression(cb);
     return *this;
 }
 
-UnleashClient& UnleashClient::onUpdate(EventHandler::UpdateCallback cb) {
-    _eventHandler->onUpdate(cb);
+UnleashClient& UnleashClient::onCircuitStateChange(CircuitStateCallback cb) {
+    _impl->eventHandler().onCircuitStateChange(std::move(cb));
     return *this;
 }
 
-UnleashClient& UnleashClient::onImpression(EventHandler::ImpressionCallback cb) {
-    _eventHandler->onImpression(cb);
+UnleashClient& UnleashClient::onImpressionBatch(ImpressionBatchCallback cb, std::size_t maxBatch,
+                                                utils::mSeconds maxDelay) {
+    _impl->eventHandler().onImpressionBatch(std::move(cb), maxBatch, maxDelay);
     return *this;
 }
 
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "internal/binaryCodec.hpp"
+#include "unleash/Domain/toggle.hpp"
+#include "unleash/Domain/variant.hpp"
+
+using unleash::BinaryCodec;
+using unleash::Toggle;
+using unleash::ToggleSet;
+using unleash::Variant;
+
+namespace {
+
+ToggleSet makeSampleSet() {
+    ToggleSet::Map m;
+    m.emplace("flag-on", Toggle{"flag-on", true, true, Variant{"variant-a", true, Variant::Payload{"json", "{}"}}});
+    m.emplace("flag-variant", Toggle{"flag-variant", true, false, Variant{"variant-b", true}});
+    m.emplace("flag-off", Toggle{"flag-off", false, false});
+    return ToggleSet(std::move(m));
+}
+
+} // namespace
+
+TEST(BinaryCodec, RoundTripsToggleSet) {
+    const ToggleSet original = makeSampleSet();
+    const auto encoded = BinaryCodec::encodeToggleSet(original);
+
+    auto decoded = BinaryCodec::decodeToggleSet(encoded.data(), encoded.size());
+    ASSERT_TRUE(decoded.has_value()) << decoded.error();
+    EXPECT_EQ(decoded->size(), 3u);
+
+    EXPECT_TRUE(decoded->isEnabled("flag-on"));
+    EXPECT_TRUE(decoded->impressionData("flag-on"));
+    const auto variant = decoded->getVariant("flag-on");
+    EXPECT_EQ(variant, (Variant{"variant-a", true, Variant::Payload{"json", "{}"}}));
+
+    EXPECT_EQ(decoded->getVariant("flag-variant"), (Variant{"variant-b", true}));
+    EXPECT_FALSE(decoded->getVariant("flag-variant").hasPayload());
+
+    EXPECT_FALSE(decoded->isEnabled("flag-off"));
+    EXPECT_EQ(decoded->getVariant("flag-off"), Variant::disabledFactory());
+}
+
+TEST(BinaryCodec, RoundTripsEmptySet) {
+    const auto encoded = BinaryCodec::encodeToggleSet(ToggleSet{});
+
+    auto decoded = BinaryCodec::decodeToggleSet(encoded.data(), encoded.size());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->size(), 0u);
+}
+
+TEST(BinaryCodec, RejectsWrongMagic) {
+    auto encoded = BinaryCodec::encodeToggleSet(makeSampleSet());
+    encoded[0] = static_cast<char>(encoded[0] ^ 0xFF);
+
+    auto decoded = BinaryCodec::decodeToggleSet(encoded.data(), encoded.size());
+    EXPECT_FALSE(decoded.has_value());
+}
+
+TEST(BinaryCodec, RejectsTruncatedInputAtAnyLength) {
+    const auto encoded = BinaryCodec::encodeToggleSet(makeSampleSet());
+
+    for (std::size_t len = 0; len < encoded.size(); ++len) {
+        auto decoded = BinaryCodec::decodeToggleSet(encoded.data(), len);
+        EXPECT_FALSE(decoded.has_value()) << "length " << len;
+    }
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "internal/circuitBreaker.hpp"
+
+using namespace unleash;
+using std::chrono::milliseconds;
+
+namespace {
+
+const CircuitBreaker::Clock::time_point t0{};
+
+bool acquire(CircuitBreaker& p_breaker, CircuitBreaker::Clock::time_point p_now,
+             CircuitBreaker::Transition* p_out = nullptr) {
+    CircuitBreaker::Transition transition;
+    const bool allowed = p_breaker.tryAcquire(transition, p_now);
+    if (p_out)
+        *p_out = transition;
+    return allowed;
+}
+
+} // namespace
+
+TEST(CircuitBreakerTest, OpensAfterConsecutiveFailures) {
+    CircuitBreaker breaker("http://edge/api/frontend", 3, milliseconds(1000));
+    EXPECT_TRUE(acquire(breaker, t0));
+    EXPECT_FALSE(breaker.onFailure(t0).has_value());
+    EXPECT_FALSE(breaker.onFailure(t0).has_value());
+    EXPECT_FALSE(breaker.onSuccess().has_value()); // a success resets the count
+    EXPECT_FALSE(breaker.onFailure(t0).has_value());
+    EXPECT_FALSE(breaker.onFailure(t0).has_value());
+
+    const auto opened = breaker.onFailure(t0);
+    ASSERT_TRUE(opened.has_value());
+    EXPECT_EQ(opened->endpoint, "http://edge/api/frontend");
+    EXPECT_EQ(opened->from, CircuitState::Closed);
+    EXPECT_EQ(opened->to, CircuitState::Open);
+    EXPECT_EQ(breaker.state(), CircuitState::Open);
+}
+
+TEST(CircuitBreakerTest, SkipsCallsWhileOpen) {
+    CircuitBreaker breaker("e", 1, milliseconds(1000));
+    breaker.onFailure(t0);
+    EXPECT_FALSE(acquire(breaker, t0 + milliseconds(999)));
+    EXPECT_EQ(breaker.remainingOpen(t0 + milliseconds(400)), milliseconds(600));
+    EXPECT_EQ(breaker.remainingOpen(t0 + milliseconds(1000)), milliseconds(0));
+}
+
+TEST(CircuitBreakerTest, HalfOpenLetsASingleProbeThrough) {
+    CircuitBreaker breaker("e", 1, milliseconds(1000));
+    breaker.onFailure(t0);
+
+    CircuitBreaker::Transition transition;
+    EXPECT_TRUE(acquire(breaker, t0 + milliseconds(1000), &transition));
+    ASSERT_TRUE(transition.has_value());
+    EXPECT_EQ(transition->from, CircuitState::Open);
+    EXPECT_EQ(transition->to, CircuitState::HalfOpen);
+    EXPECT_FALSE(acquire(breaker, t0 + milliseconds(1001)));
+
+    const auto closed = breaker.onSuccess();
+    ASSERT_TRUE(closed.has_value());
+    EXPECT_EQ(closed->to, CircuitState::Closed);
+    EXPECT_TRUE(acquire(breaker, t0 + milliseconds(1002)));
+}
+
+TEST(CircuitBreakerTest, FailedProbeReopens) {
+    CircuitBreaker breaker("e", 2, milliseconds(1000));
+    breaker.onFailure(t0);
+    breaker.onFailure(t0);
+    ASSERT_TRUE(acquire(breaker, t0 + milliseconds(1000)));
+
+    const auto reopened = breaker.onFailure(t0 + milliseconds(1500));
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->from, CircuitState::HalfOpen);
+    EXPECT_EQ(reopened->to, CircuitState::Open);
+    EXPECT_FALSE(acquire(breaker, t0 + milliseconds(2000)));
+    EXPECT_TRUE(acquire(breaker, t0 + milliseconds(2500)));
+}
+
+TEST(CircuitBreakerTest, ReleasedProbeCanBeRetried) {
+    CircuitBreaker breaker("e", 1, milliseconds(10));
+    breaker.onFailure(t0);
+    ASSERT_TRUE(acquire(breaker, t0 + milliseconds(10)));
+    breaker.release();
+    EXPECT_EQ(breaker.state(), CircuitState::HalfOpen);
+    EXPECT_TRUE(acquire(breaker, t0 + milliseconds(11)));
+}
+
+TEST(CircuitBreakerTest, ZeroThresholdDisablesTheBreaker) {
+    CircuitBreaker breaker("e", 0, milliseconds(1000));
+    EXPECT_FALSE(breaker.enabled());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_FALSE(breaker.onFailure(t0).has_value());
+    EXPECT_EQ(breaker.state(), CircuitState::Closed);
+    EXPECT_TRUE(acquire(breaker, t0));
+}
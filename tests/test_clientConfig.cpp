@@ -192,4 +192,82 @@ TEST(ClientConfig, StorageProvider_SetterReplacesProviderAndIgnoresNull) {
     // Null should not overwrite a valid provider.
     cfg.setStorageProvider(nullptr);
     EXPECT_EQ(cfg.storageProvider(), replacement);
-}
\ No newline at end of file
+}
+TEST(ClientConfig, EventQueueDefaultsSettersAndValidation) {
+    ClientConfig cfg("http://example", "key123", "cppApp");
+    EXPECT_EQ(cfg.eventQueueCapacity(), utils::maxEventQueueSize);
+    EXPECT_EQ(cfg.eventOverflowPolicy(), EventOverflowPolicy::DropNewest);
+    EXPECT_EQ(cfg.eventBlockTimeout(), utils::eventBlockTimeout);
+
+    cfg.setEventQueueCapacity(1024)
+        .setEventOverflowPolicy(EventOverflowPolicy::Block)
+        .setEventBlockTimeout(utils::mSeconds{50});
+    EXPECT_EQ(cfg.eventQueueCapacity(), 1024u);
+    EXPECT_EQ(cfg.eventOverflowPolicy(), EventOverflowPolicy::Block);
+    EXPECT_EQ(cfg.eventBlockTimeout(), utils::mSeconds{50});
+    EXPECT_TRUE(cfg.isValid());
+
+    cfg.setEventQueueCapacity(0);
+    EXPECT_FALSE(cfg.isValid());
+}
+
+TEST(ClientConfig, ContextUpdateDebounceDefaultSetterAndValidation) {
+    ClientConfig cfg("http://example", "key123", "cppApp");
+    EXPECT_EQ(cfg.contextUpdateDebounce(), utils::mSeconds{0});
+
+    cfg.setContextUpdateDebounce(utils::mSeconds{150});
+    EXPECT_EQ(cfg.contextUpdateDebounce(), utils::mSeconds{150});
+    EXPECT_TRUE(cfg.isValid());
+
+    cfg.setContextUpdateDebounce(utils::mSeconds{-1});
+    EXPECT_FALSE(cfg.isValid());
+}
+
+TEST(ClientConfig, CircuitBreakerIsOffByDefault) {
+    ClientConfig cfg("http://example", "key123", "cppApp");
+    EXPECT_EQ(cfg.circuitBreakerThreshold(), 0u);
+
+    cfg.setCircuitBreaker(5, utils::mSeconds{30000});
+    EXPECT_EQ(cfg.circuitBreakerThreshold(), 5u);
+    EXPECT_EQ(cfg.circuitBreakerOpenDuration(), utils::mSeconds{30000});
+    EXPECT_TRUE(cfg.isValid());
+
+    cfg.setCircuitBreaker(5, utils::mSeconds{-1});
+    EXPECT_FALSE(cfg.isValid());
+}
+
+TEST(ClientConfig, SetUrlsReplacesTheEndpoint) {
+    ClientConfig cfg("http://example", "key123", "cppApp");
+    ASSERT_EQ(cfg.urls().size(), 1u);
+    EXPECT_EQ(cfg.urls().front(), "http://example");
+
+    cfg.setUrls({"http://edge-a", "http://edge-b"});
+    EXPECT_EQ(cfg.url(), "http://edge-a");
+    EXPECT_EQ(cfg.urls().size(), 2u);
+    EXPECT_TRUE(cfg.isValid());
+
+    cfg.setUrls({"http://edge-a", ""});
+    EXPECT_FALSE(cfg.isValid());
+    cfg.setUrls({});
+    EXPECT_FALSE(cfg.isValid());
+}
+
+TEST(ClientConfig, FetchHedgingIsOffByDefault) {
+    ClientConfig cfg("http://example", "key123", "cppApp");
+    EXPECT_EQ(cfg.fetchHedgePercentile(), 0.0);
+
+    cfg.setFetchHedging(0.95, utils::mSeconds{200});
+    EXPECT_EQ(cfg.fetchHedgePercentile(), 0.95);
+    EXPECT_EQ(cfg.fetchHedgeInitialDelay(), utils::mSeconds{200});
+    EXPECT_TRUE(cfg.isValid());
+
+    cfg.setFetchHedging(95, utils::mSeconds{200});
+    EXPECT_FALSE(cfg.isValid());
+}
+
+TEST(ClientConfig, PreconnectIsOffByDefault) {
+    ClientConfig cfg("http://example", "key123", "cppApp");
+    EXPECT_FALSE(cfg.preconnect());
+    cfg.setPreconnect(true);
+    EXPECT_TRUE(cfg.preconnect());
+}
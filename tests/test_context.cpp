@@ -107,3 +107,55 @@ TEST(ContextTest, SetCurrentTimeProperty) {
     ctx.updateMutableContext(mCtx);
     EXPECT_TRUE(ctx.getCurrentTime().has_value());
 }
+
+TEST(ContextTest, FingerprintTracksEffectiveMutableFields) {
+    MutableContext a{};
+    MutableContext b{};
+    EXPECT_EQ(a.fingerprint(), b.fingerprint());
+
+    a.setUserId("u1").setProperty("plan", "pro").setProperty("region", "eu");
+    b.setProperty("region", "eu").setProperty("plan", "pro").setUserId("u1");
+    EXPECT_EQ(a.fingerprint(), b.fingerprint()); // property order does not matter
+
+    b.setProperty("plan", "free");
+    EXPECT_NE(a.fingerprint(), b.fingerprint());
+
+    // Same bytes in different fields:
+    MutableContext user{};
+    MutableContext address{};
+    user.setUserId("x");
+    address.setRemoteAddress("x");
+    EXPECT_NE(user.fingerprint(), address.fingerprint());
+    EXPECT_NE(user.fingerprint(), MutableContext{}.fingerprint());
+}
+
+TEST(ContextTest, ContextFingerprintFollowsMutableContext) {
+    Context ctx("myApp");
+    MutableContext mCtx{};
+    mCtx.setUserId("u1");
+    ctx.updateMutableContext(mCtx);
+    EXPECT_EQ(ctx.fingerprint(), mCtx.fingerprint());
+}
+
+TEST(ContextTest, EqualityComparesFieldsAndIgnoresPropertyOrder) {
+    MutableContext a{};
+    MutableContext b{};
+    EXPECT_EQ(a, b);
+
+    a.setUserId("u1").setProperty("plan", "pro").setProperty("region", "eu");
+    b.setProperty("region", "eu").setProperty("plan", "pro").setUserId("u1");
+    EXPECT_EQ(a, b);
+
+    b.setProperty("plan", "free");
+    EXPECT_NE(a, b);
+
+    MutableContext user{};
+    MutableContext address{};
+    user.setUserId("x");
+    address.setRemoteAddress("x");
+    EXPECT_NE(user, address);
+
+    Context ctx("myApp");
+    ctx.updateMutableContext(a);
+    EXPECT_EQ(ctx.getMutableContext(), a);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include "unleash/Fetcher/endpointSelector.hpp"
+
+using namespace unleash;
+using std::chrono::milliseconds;
+
+namespace {
+
+const EndpointSelector::Clock::time_point t0{};
+
+} // namespace
+
+TEST(EndpointSelectorTest, TriesUnmeasuredEndpointsFirstThenTheFastest) {
+    EndpointSelector selector({"http://a", "http://b", "http://c"});
+    EXPECT_EQ(selector.pick(0, t0), 0u);
+    selector.onSuccess(0, milliseconds(80));
+    EXPECT_EQ(selector.pick(0, t0), 1u);
+    selector.onSuccess(1, milliseconds(20));
+    EXPECT_EQ(selector.pick(0, t0), 2u);
+    selector.onSuccess(2, milliseconds(50));
+
+    EXPECT_EQ(selector.pick(0, t0), 1u);
+    EXPECT_DOUBLE_EQ(selector.stats(1).latencyMs, 20.0);
+
+    // b gets slower: the moving average follows and c takes over.
+    for (int i = 0; i < 5; ++i)
+        selector.onSuccess(1, milliseconds(200));
+    EXPECT_GT(selector.stats(1).latencyMs, 50.0);
+    EXPECT_EQ(selector.pick(0, t0), 2u);
+}
+
+TEST(EndpointSelectorTest, SkipsTriedAndFailedEndpoints) {
+    EndpointSelector selector({"http://a", "http://b"}, milliseconds(1000), milliseconds(4000));
+    selector.onSuccess(0, milliseconds(10));
+    selector.onSuccess(1, milliseconds(30));
+    EXPECT_EQ(selector.pick(0b01, t0), 1u);
+    EXPECT_FALSE(selector.pick(0b11, t0).has_value());
+
+    selector.onFailure(0, t0);
+    EXPECT_GT(selector.stats(0).errorRate, 0.0);
+    EXPECT_EQ(selector.pick(0, t0 + milliseconds(999)), 1u);
+    // Cooldown over: the faster endpoint is back.
+    EXPECT_EQ(selector.pick(0, t0 + milliseconds(1000)), 0u);
+
+    // Consecutive failures double the cooldown, up to the max.
+    selector.onFailure(0, t0);
+    EXPECT_EQ(selector.stats(0).retryAt, t0 + milliseconds(2000));
+    selector.onFailure(0, t0);
+    selector.onFailure(0, t0);
+    EXPECT_EQ(selector.stats(0).retryAt, t0 + milliseconds(4000));
+
+    selector.onSuccess(0, milliseconds(10));
+    EXPECT_EQ(selector.stats(0).consecutiveFailures, 0u);
+}
+
+TEST(EndpointSelectorTest, AllFailingPicksTheEarliestRetry) {
+    EndpointSelector selector({"http://a", "http://b"});
+    selector.onFailure(0, t0 + milliseconds(500));
+    selector.onFailure(1, t0);
+    EXPECT_EQ(selector.pick(0, t0 + milliseconds(600)), 1u);
+}
+
+TEST(EndpointSelectorTest, ErrorRateWeighsAgainstLatency) {
+    EndpointSelector selector({"http://fast-flaky", "http://steady"}, milliseconds(0), milliseconds(0));
+    selector.onSuccess(0, milliseconds(10));
+    selector.onSuccess(1, milliseconds(15));
+    for (int i = 0; i < 3; ++i)
+        selector.onFailure(0, t0);
+    EXPECT_EQ(selector.pick(0, t0), 1u);
+}
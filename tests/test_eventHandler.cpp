@@ -6,9 +6,17 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using namespace std::chrono_literals;
 
@@ -86,7 +94,7 @@ TEST(EventHandler, EmitsImpressionWithPayload) {
     std::string variantName;
 
     eh.onImpression([&](const unleash::EventHandler::ClientImpression& impressionEvent) {
-        contextName = impressionEvent.ctx.getAppName();
+        contextName = impressionEvent.ctx->getAppName();
         flag = impressionEvent.flagName;
         enabled = impressionEvent.enabled;
         eventType = impressionEvent.eventType;
@@ -96,7 +104,7 @@ TEST(EventHandler, EmitsImpressionWithPayload) {
     });
 
     unleash::EventHandler::ClientImpression event{
-        unleash::Context{"myTestApp"}, "myFlag", true, "getVariant", false, "variant1"};
+        std::make_shared<const unleash::Context>("myTestApp"), "myFlag", true, "getVariant", false, "variant1"};
     eh.emitImpression(event);
 
     ASSERT_TRUE(w.waitFor(500ms)) << "Impression callback was not invoked in time";
@@ -200,3 +208,275 @@ TEST(EventHandler, CallbackExceptionDoesNotKillThread) {
 
     eh.stop();
 }
+
+namespace {
+
+// Holds the dispatch thread inside an error callback so that the test controls when the queue drains.
+struct BlockedDispatcher {
+    std::mutex m;
+    std::condition_variable cv;
+    bool entered = false;
+    bool released = false;
+    std::vector<std::string> messages;
+
+    void install(unleash::EventHandler& eh) {
+        eh.onError([this](const unleash::ClientError& err) {
+            std::unique_lock<std::mutex> lk(m);
+            messages.push_back(err.message);
+            entered = true;
+            cv.notify_all();
+            cv.wait(lk, [&] { return released; });
+        });
+        eh.emitError({"first", ""});
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait_for(lk, 1s, [&] { return entered; });
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            released = true;
+        }
+        cv.notify_all();
+    }
+};
+
+bool waitUntil(const std::function<bool()>& predicate, std::chrono::milliseconds timeout = 1s) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(EventHandler, DropNewestCountsDroppedEvents) {
+    unleash::EventHandler eh(2, unleash::EventOverflowPolicy::DropNewest);
+    eh.start();
+    BlockedDispatcher blocked;
+    blocked.install(eh);
+
+    for (int i = 0; i < 5; ++i)
+        eh.emitError({std::to_string(i), ""});
+    blocked.release();
+
+    ASSERT_TRUE(waitUntil([&] { return eh.stats()[unleash::ClientEvent::Error].dispatched == 3; }));
+    const auto stats = eh.stats()[unleash::ClientEvent::Error];
+    EXPECT_EQ(stats.enqueued, 3u);
+    EXPECT_EQ(stats.dropped, 3u);
+    eh.stop();
+
+    std::lock_guard<std::mutex> lk(blocked.m);
+    EXPECT_EQ(blocked.messages, (std::vector<std::string>{"first", "0", "1"}));
+}
+
+TEST(EventHandler, DropOldestKeepsLatestEvents) {
+    unleash::EventHandler eh(2, unleash::EventOverflowPolicy::DropOldest);
+    eh.start();
+    BlockedDispatcher blocked;
+    blocked.install(eh);
+
+    for (int i = 0; i < 5; ++i)
+        eh.emitError({std::to_string(i), ""});
+    blocked.release();
+
+    ASSERT_TRUE(waitUntil([&] { return eh.stats()[unleash::ClientEvent::Error].dispatched == 3; }));
+    EXPECT_EQ(eh.stats()[unleash::ClientEvent::Error].dropped, 3u);
+    eh.stop();
+
+    std::lock_guard<std::mutex> lk(blocked.m);
+    EXPECT_EQ(blocked.messages, (std::vector<std::string>{"first", "3", "4"}));
+}
+
+TEST(EventHandler, BlockWaitsForRoom) {
+    unleash::EventHandler eh(2, unleash::EventOverflowPolicy::Block, 2000ms);
+    eh.start();
+    BlockedDispatcher blocked;
+    blocked.install(eh);
+
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(50ms);
+        blocked.release();
+    });
+    for (int i = 0; i < 5; ++i)
+        eh.emitError({std::to_string(i), ""});
+    releaser.join();
+
+    ASSERT_TRUE(waitUntil([&] { return eh.stats()[unleash::ClientEvent::Error].dispatched == 6; }));
+    EXPECT_EQ(eh.stats()[unleash::ClientEvent::Error].dropped, 0u);
+    eh.stop();
+}
+
+TEST(EventHandler, CoalescePendingUpdates) {
+    unleash::EventHandler eh(8, unleash::EventOverflowPolicy::Coalesce);
+    eh.start();
+    std::atomic<int> updates{0};
+    eh.onUpdate([&] { updates.fetch_add(1); });
+    BlockedDispatcher blocked;
+    blocked.install(eh);
+
+    for (int i = 0; i < 5; ++i)
+        eh.emitUpdate();
+    blocked.release();
+    ASSERT_TRUE(waitUntil([&] { return updates.load() == 1; }));
+
+    // Once dispatched, a new update is queued again:
+    eh.emitUpdate();
+    ASSERT_TRUE(waitUntil([&] { return updates.load() == 2; }));
+
+    const auto stats = eh.stats()[unleash::ClientEvent::Update];
+    EXPECT_EQ(stats.enqueued, 2u);
+    EXPECT_EQ(stats.coalesced, 4u);
+    EXPECT_EQ(stats.dispatched, 2u);
+    EXPECT_GE(stats.maxLatency.count(), 0);
+    eh.stop();
+}
+
+TEST(EventHandler, ImpressionBatchFlushesOnSizeAndDelay) {
+    unleash::EventHandler eh(64);
+    eh.start();
+
+    std::mutex m;
+    std::vector<std::vector<std::string>> batches;
+    eh.onImpressionBatch(
+        [&](const std::vector<unleash::ClientImpression>& batch) {
+            std::vector<std::string> flags;
+            for (const auto& impression : batch)
+                flags.push_back(impression.flagName);
+            std::lock_guard<std::mutex> lk(m);
+            batches.push_back(std::move(flags));
+        },
+        3, 50ms);
+
+    auto emit = [&](const std::string& flag) {
+        eh.emitImpression(unleash::ClientImpression{std::make_shared<const unleash::Context>("app"), flag, true,
+                                                    "isEnabled", false});
+    };
+    for (const char* flag : {"a", "b", "c", "d"})
+        emit(flag);
+
+    // "a".."c" fill a batch, "d" goes out once its delay has elapsed.
+    ASSERT_TRUE(waitUntil([&] {
+        std::lock_guard<std::mutex> lk(m);
+        return batches.size() == 2;
+    }));
+    std::lock_guard<std::mutex> lk(m);
+    EXPECT_EQ(batches[0], (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(batches[1], (std::vector<std::string>{"d"}));
+    eh.stop();
+}
+
+TEST(EventHandler, ImpressionBatchIsFlushedOnStop) {
+    unleash::EventHandler eh(64);
+    eh.start();
+
+    std::atomic<std::size_t> delivered{0};
+    eh.onImpressionBatch([&](const std::vector<unleash::ClientImpression>& batch) { delivered += batch.size(); }, 100,
+                         10s);
+    eh.emitImpression(
+        unleash::ClientImpression{std::make_shared<const unleash::Context>("app"), "a", true, "isEnabled", false});
+    ASSERT_TRUE(waitUntil([&] { return eh.stats()[unleash::ClientEvent::Impression].dispatched == 1; }));
+    EXPECT_EQ(delivered.load(), 0u);
+
+    eh.stop();
+    EXPECT_EQ(delivered.load(), 1u);
+}
+
+TEST(EventHandler, MultipleListenersAndRemovalByToken) {
+    unleash::EventHandler eh;
+    eh.start();
+
+    std::atomic<int> primary{0};
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+    eh.onUpdate([&] { primary.fetch_add(1); });
+    const auto firstToken = eh.addUpdateListener([&] { first.fetch_add(1); });
+    const auto secondToken = eh.addUpdateListener([&] { second.fetch_add(1); });
+    EXPECT_NE(firstToken, 0u);
+    EXPECT_NE(firstToken, secondToken);
+
+    eh.emitUpdate();
+    ASSERT_TRUE(waitUntil([&] { return primary == 1 && first == 1 && second == 1; }));
+
+    // onUpdate() only replaces its own callback:
+    std::atomic<int> replaced{0};
+    eh.onUpdate([&] { replaced.fetch_add(1); });
+    EXPECT_TRUE(eh.removeListener(firstToken));
+    EXPECT_FALSE(eh.removeListener(firstToken));
+
+    eh.emitUpdate();
+    ASSERT_TRUE(waitUntil([&] { return replaced == 1 && second == 2; }));
+    EXPECT_EQ(primary.load(), 1);
+    EXPECT_EQ(first.load(), 1);
+
+    EXPECT_TRUE(eh.removeListener(secondToken));
+    eh.onUpdate(nullptr);
+    eh.emitUpdate();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(eh.stats()[unleash::ClientEvent::Update].enqueued, 2u);
+    eh.stop();
+}
+
+TEST(EventHandler, ThrowingListenerDoesNotSkipOthers) {
+    unleash::EventHandler eh;
+    eh.start();
+
+    Waiter w;
+    eh.addErrorListener([](const unleash::ClientError&) { throw std::runtime_error("boom"); });
+    eh.addErrorListener([&](const unleash::ClientError&) { w.signal(); });
+    eh.emitError({"error", ""});
+
+    ASSERT_TRUE(w.waitFor(1s));
+    eh.stop();
+}
+
+TEST(EventHandler, EmitsCircuitStateChange) {
+    unleash::EventHandler eh;
+    eh.start();
+
+    Waiter w;
+    unleash::CircuitStateChange seen;
+    eh.onCircuitStateChange([&](const unleash::CircuitStateChange& change) {
+        seen = change;
+        w.signal();
+    });
+
+    eh.emitCircuitStateChange({"http://edge/api/frontend", unleash::CircuitState::Closed, unleash::CircuitState::Open});
+
+    ASSERT_TRUE(w.waitFor(500ms)) << "Circuit callback was not invoked in time";
+    EXPECT_EQ(seen.endpoint, "http://edge/api/frontend");
+    EXPECT_EQ(seen.from, unleash::CircuitState::Closed);
+    EXPECT_EQ(seen.to, unleash::CircuitState::Open);
+
+    eh.stop();
+}
+
+#if !defined(_WIN32)
+TEST(EventHandler, DispatchesAgainInAForkChild) {
+    unleash::EventHandler eh;
+    eh.start();
+    Waiter w;
+    eh.onUpdate([&] { w.signal(); });
+
+    eh.prepareFork();
+    const pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        eh.childAfterFork();
+        eh.emitUpdate();
+        ::_exit(w.waitFor(1s) ? 0 : 1);
+    }
+    eh.parentAfterFork();
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0) << "Update callback was not invoked in the child";
+
+    eh.emitUpdate();
+    EXPECT_TRUE(w.waitFor(1s)) << "Update callback was not invoked in the parent";
+
+    eh.stop();
+}
+#endif
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "internal/eventRing.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace unleash;
+
+namespace {
+
+bool pushError(EventRing& ring, const std::string& message) {
+    return ring.tryPush([&](EventRecord& r) {
+        r.type = ClientEvent::Error;
+        r.error.message = message;
+    });
+}
+
+} // namespace
+
+TEST(EventRingTest, CapacityIsRoundedUpToPowerOfTwo) {
+    EXPECT_EQ(EventRing(30).capacity(), 32u);
+    EXPECT_EQ(EventRing(32).capacity(), 32u);
+    EXPECT_EQ(EventRing(1).capacity(), 2u);
+}
+
+TEST(EventRingTest, PopsInFifoOrder) {
+    EventRing ring(4);
+    EXPECT_TRUE(ring.empty());
+
+    ASSERT_TRUE(pushError(ring, "a"));
+    ASSERT_TRUE(pushError(ring, "b"));
+    EXPECT_FALSE(ring.empty());
+
+    EventRecord out;
+    ASSERT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out.type, ClientEvent::Error);
+    EXPECT_EQ(out.error.message, "a");
+    ASSERT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out.error.message, "b");
+    EXPECT_FALSE(ring.tryPop(out));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(EventRingTest, RejectsPushWhenFullAndAcceptsAgainAfterPop) {
+    EventRing ring(4);
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(pushError(ring, std::to_string(i)));
+    EXPECT_FALSE(pushError(ring, "overflow"));
+
+    EventRecord out;
+    ASSERT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out.error.message, "0");
+    EXPECT_TRUE(pushError(ring, "4"));
+
+    for (const char* expected : {"1", "2", "3", "4"}) {
+        ASSERT_TRUE(ring.tryPop(out));
+        EXPECT_EQ(out.error.message, expected);
+    }
+}
+
+TEST(EventRingTest, ConcurrentProducersLoseNothingAndKeepTheirOrder) {
+    EventRing ring(1024);
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+
+    std::atomic<bool> done{false};
+    std::vector<int> next(producers, 0);
+    bool ordered = true;
+    std::thread consumer([&] {
+        EventRecord out;
+        for (;;) {
+            if (ring.tryPop(out)) {
+                const int producer = std::stoi(out.impression.flagName);
+                ordered = ordered && std::stoi(out.impression.variant) == next[producer];
+                ++next[producer];
+                continue;
+            }
+            if (done.load(std::memory_order_acquire) && ring.empty())
+                break;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                while (!ring.tryPush([p, i](EventRecord& r) {
+                    r.type = ClientEvent::Impression;
+                    r.impression.flagName = std::to_string(p);
+                    r.impression.variant = std::to_string(i);
+                })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    EXPECT_TRUE(ordered);
+    for (int p = 0; p < producers; ++p)
+        EXPECT_EQ(next[p], perProducer);
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "unleash/Domain/toggle.hpp"
+#include "unleash/Domain/toggleSet.hpp"
+#include "unleash/Store/fileWatchStorageProvider.hpp"
+#include "unleash/Store/storageProvider.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct TempDir {
+    std::filesystem::path path;
+
+    TempDir() {
+        const auto ts = std::chrono::steady_clock::now().time_since_epoch().count();
+        path = std::filesystem::temp_directory_path() / ("unleash-cpp-sdk-watch-test-" + std::to_string(ts));
+    }
+
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+};
+
+struct SnapshotWaiter {
+    std::mutex m;
+    std::condition_variable cv;
+    std::optional<unleash::ToggleSet> last;
+    int count = 0;
+
+    void push(unleash::ToggleSet t) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            last = std::move(t);
+            ++count;
+        }
+        cv.notify_all();
+    }
+
+    bool waitForCount(int expected, std::chrono::milliseconds timeout = 2s) {
+        std::unique_lock<std::mutex> lk(m);
+        return cv.wait_for(lk, timeout, [&] { return count >= expected; });
+    }
+};
+
+unleash::ToggleSet makeSet(const std::string& name, bool enabled) {
+    unleash::ToggleSet::Map m;
+    m.emplace(name, unleash::Toggle{name, enabled, false});
+    return unleash::ToggleSet(std::move(m));
+}
+
+} // namespace
+
+TEST(FileWatchStorageProvider, DefaultProvidersDoNotSupportWatching) {
+    TempDir dir;
+    unleash::LocalStorageProvider local;
+    unleash::FileStorageProvider file("cppApp", dir.path.string());
+
+    EXPECT_FALSE(local.watch([](unleash::ToggleSet) {}));
+    EXPECT_FALSE(file.watch([](unleash::ToggleSet) {}));
+}
+
+TEST(FileWatchStorageProvider, SharesBackupFileWithFileStorageProvider) {
+    TempDir dir;
+    unleash::FileStorageProvider writer("cppApp", dir.path.string());
+    unleash::FileWatchStorageProvider reader("cppApp", dir.path.string());
+
+    EXPECT_EQ(reader.filePath(), writer.filePath());
+
+    writer.save(makeSet("flag-a", true));
+    const auto loaded = reader.get();
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_TRUE(loaded->isEnabled("flag-a"));
+}
+
+TEST(FileWatchStorageProvider, NotifiesWhenWriterReplacesBackupFile) {
+    TempDir dir;
+    unleash::FileStorageProvider writer("cppApp", dir.path.string());
+    unleash::FileWatchStorageProvider reader("cppApp", dir.path.string());
+
+    SnapshotWaiter waiter;
+    ASSERT_TRUE(reader.watch([&](unleash::ToggleSet t) { waiter.push(std::move(t)); }));
+
+    writer.save(makeSet("flag-a", true));
+    ASSERT_TRUE(waiter.waitForCount(1)) << "No snapshot received after first save";
+    {
+        std::lock_guard<std::mutex> lk(waiter.m);
+        EXPECT_TRUE(waiter.last->isEnabled("flag-a"));
+    }
+
+    const int seen = [&] {
+        std::lock_guard<std::mutex> lk(waiter.m);
+        return waiter.count;
+    }();
+    writer.save(makeSet("flag-b", true));
+    ASSERT_TRUE(waiter.waitForCount(seen + 1)) << "No snapshot received after second save";
+    {
+        std::lock_guard<std::mutex> lk(waiter.m);
+        EXPECT_TRUE(waiter.last->contains("flag-b"));
+        EXPECT_FALSE(waiter.last->contains("flag-a"));
+    }
+
+    reader.unwatch();
+}
+
+TEST(FileWatchStorageProvider, IgnoresInvalidContentAndOtherFiles) {
+    TempDir dir;
+    unleash::FileWatchStorageProvider reader("cppApp", dir.path.string());
+
+    SnapshotWaiter waiter;
+    ASSERT_TRUE(reader.watch([&](unleash::ToggleSet t) { waiter.push(std::move(t)); }));
+
+    {
+        std::ofstream out(reader.filePath(), std::ios::binary);
+        out << "{ definitely-not-valid-json ";
+    }
+    {
+        std::ofstream out(dir.path / "unrelated.json", std::ios::binary);
+        out << R"({"toggles":[]})";
+    }
+
+    EXPECT_FALSE(waiter.waitForCount(1, 600ms));
+}
+
+TEST(FileWatchStorageProvider, UnwatchIsIdempotentAndStopsNotifications) {
+    TempDir dir;
+    unleash::FileStorageProvider writer("cppApp", dir.path.string());
+    unleash::FileWatchStorageProvider reader("cppApp", dir.path.string());
+
+    // unwatch without watch should be safe
+    reader.unwatch();
+
+    SnapshotWaiter waiter;
+    ASSERT_TRUE(reader.watch([&](unleash::ToggleSet t) { waiter.push(std::move(t)); }));
+    reader.unwatch();
+    reader.unwatch();
+
+    writer.save(makeSet("flag-a", true));
+    EXPECT_FALSE(waiter.waitForCount(1, 600ms));
+}
+
+TEST(FileWatchStorageProvider, DoesNotNotifyItsOwnSaves) {
+    TempDir dir;
+    unleash::FileStorageProvider writer("cppApp", dir.path.string());
+    unleash::FileWatchStorageProvider provider("cppApp", dir.path.string());
+
+    SnapshotWaiter waiter;
+    ASSERT_TRUE(provider.watch([&](unleash::ToggleSet t) { waiter.push(std::move(t)); }));
+
+    // A polling client persisting its fetch must not get it back as a change:
+    provider.save(makeSet("flag-a", true));
+    EXPECT_FALSE(waiter.waitForCount(1, 600ms));
+    ASSERT_TRUE(provider.get().has_value());
+
+    // Other writers still are:
+    writer.save(makeSet("flag-b", true));
+    ASSERT_TRUE(waiter.waitForCount(1));
+    {
+        std::lock_guard<std::mutex> lk(waiter.m);
+        EXPECT_TRUE(waiter.last->contains("flag-b"));
+    }
+
+    provider.unwatch();
+}
+
+#if !defined(_WIN32)
+TEST(FileWatchStorageProvider, WatchesAgainInAForkChild) {
+    TempDir dir;
+    unleash::FileStorageProvider writer("cppApp", dir.path.string());
+    unleash::FileWatchStorageProvider reader("cppApp", dir.path.string());
+
+    SnapshotWaiter waiter;
+    ASSERT_TRUE(reader.watch([&](unleash::ToggleSet t) { waiter.push(std::move(t)); }));
+
+    reader.prepareFork();
+    const pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        reader.childAfterFork();
+        writer.save(makeSet("flag-child", true));
+        ::_exit(waiter.waitForCount(1) ? 0 : 1);
+    }
+    reader.parentAfterFork();
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0) << "The child was not notified";
+
+    // The parent's watch is left as it was:
+    writer.save(makeSet("flag-parent", true));
+    std::unique_lock<std::mutex> lk(waiter.m);
+    EXPECT_TRUE(waiter.cv.wait_for(lk, 2s, [&] { return waiter.last && waiter.last->contains("flag-parent"); }));
+    lk.unlock();
+
+    reader.unwatch();
+}
+#endif
@@ -16,6 +16,12 @@ TEST(FlagStore, StartsNotReady) {
     EXPECT_FALSE(store.isReady());
 }
 
+TEST(FlagStore, RefreshWithoutSegmentIsANoOp) {
+    FlagStore store;
+    store.refresh();
+    EXPECT_FALSE(store.isReady());
+}
+
 TEST(FlagStore, HasNonNullSnapshotOnConstruction) {
     FlagStore store;
 
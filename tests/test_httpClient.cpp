@@ -127,7 +127,7 @@ static ParsedRequest parseHttpRequest(const std::string& raw) {
 }
 
 static std::string httpResponse(long status, const std::vector<std::pair<std::string, std::string>>& headers,
-                                const std::string& body) {
+                                const std::string& body, bool keepAlive = false) {
     std::ostringstream oss;
     if (status == 200)
         oss << "HTTP/1.1 200 OK\r\n";
@@ -140,7 +140,7 @@ static std::string httpResponse(long status, const std::vector<std::pair<std::st
         oss << h.first << ": " << h.second << "\r\n";
     }
     oss << "Content-Length: " << body.size() << "\r\n";
-    oss << "Connection: close\r\n\r\n";
+    oss << (keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
     oss << body;
     return oss.str();
 }
@@ -207,6 +207,20 @@ class TinyHttpServer {
         return _lastPostBody;
     }
 
+    std::vector<std::string> methods() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _methods;
+    }
+
+    // Keeps connections open between requests (one connection at a time) instead of closing after each answer.
+    void setKeepAlive(bool keepAlive) {
+        _keepAlive.store(keepAlive);
+    }
+
+    int connections() const {
+        return _connections.load();
+    }
+
   private:
     void tryWake() {
         SOCKET s = ::socket(AF_INET, SOCK_STREAM, 0);
@@ -227,75 +241,87 @@ class TinyHttpServer {
             SOCKET c = ::accept(_listenSock, (sockaddr*)&client, &clen);
             if (!socket_valid(c))
                 continue;
+            ++_connections;
+            while (serve(c) && _running.load()) {
+            }
+            closesock(c);
+        }
+    }
 
-            std::string raw;
-            raw.reserve(4096);
-            char buf[2048];
+    // Answers one request; returns whether the connection stays open for the next one.
+    bool serve(SOCKET c) {
+        std::string raw;
+        raw.reserve(4096);
+        char buf[2048];
 
-            while (true) {
+        while (true) {
 #ifdef _WIN32
-                int n = ::recv(c, buf, (int)sizeof(buf), 0);
+            int n = ::recv(c, buf, (int)sizeof(buf), 0);
 #else
-                int n = ::recv(c, buf, sizeof(buf), 0);
+            int n = ::recv(c, buf, sizeof(buf), 0);
 #endif
-                if (n <= 0)
-                    break;
-                raw.append(buf, buf + n);
-                if (raw.find("\r\n\r\n") != std::string::npos)
-                    break;
-            }
+            if (n <= 0)
+                return false;
+            raw.append(buf, buf + n);
+            if (raw.find("\r\n\r\n") != std::string::npos)
+                break;
+        }
 
-            ParsedRequest req = parseHttpRequest(raw);
-            auto itCL = req.headers.find("content-length");
-            size_t wantBody = 0;
-            if (itCL != req.headers.end()) {
-                wantBody = static_cast<size_t>(std::stoul(itCL->second));
-            }
+        ParsedRequest req = parseHttpRequest(raw);
+        auto itCL = req.headers.find("content-length");
+        size_t wantBody = 0;
+        if (itCL != req.headers.end()) {
+            wantBody = static_cast<size_t>(std::stoul(itCL->second));
+        }
 
-            auto headerEnd = raw.find("\r\n\r\n");
-            std::string alreadyBody;
-            if (headerEnd != std::string::npos) {
-                alreadyBody = raw.substr(headerEnd + 4);
-            }
-            while (alreadyBody.size() < wantBody) {
+        auto headerEnd = raw.find("\r\n\r\n");
+        std::string alreadyBody;
+        if (headerEnd != std::string::npos) {
+            alreadyBody = raw.substr(headerEnd + 4);
+        }
+        while (alreadyBody.size() < wantBody) {
 #ifdef _WIN32
-                int n = ::recv(c, buf, (int)sizeof(buf), 0);
+            int n = ::recv(c, buf, (int)sizeof(buf), 0);
 #else
-                int n = ::recv(c, buf, sizeof(buf), 0);
+            int n = ::recv(c, buf, sizeof(buf), 0);
 #endif
-                if (n <= 0)
-                    break;
-                alreadyBody.append(buf, buf + n);
-            }
-            if (wantBody > 0)
-                req.body = alreadyBody.substr(0, wantBody);
-
-            const std::string etag = R"(W/"abc")";
-
-            if (req.method == "GET" && req.path == "/etag") {
-                auto inm = req.headers.find("if-none-match");
-                if (inm != req.headers.end() && inm->second == etag) {
-                    auto resp = httpResponse(304, {{"ETag", etag}}, "");
-                    ::send(c, resp.c_str(), (int)resp.size(), 0);
-                } else {
-                    auto resp =
-                        httpResponse(200, {{"Content-Type", "application/json"}, {"ETag", etag}}, R"({"ok":true})");
-                    ::send(c, resp.c_str(), (int)resp.size(), 0);
-                }
-            } else if (req.method == "POST" && req.path == "/post") {
-                {
-                    std::lock_guard<std::mutex> g(_mtx);
-                    _lastPostBody = req.body;
-                }
-                auto resp = httpResponse(200, {{"Content-Type", "text/plain"}}, "ok");
-                ::send(c, resp.c_str(), (int)resp.size(), 0);
+            if (n <= 0)
+                break;
+            alreadyBody.append(buf, buf + n);
+        }
+        if (wantBody > 0)
+            req.body = alreadyBody.substr(0, wantBody);
+
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _methods.push_back(req.method);
+        }
+        const std::string etag = R"(W/"abc")";
+        const bool keepAlive = _keepAlive.load();
+
+        std::string resp;
+        if ((req.method == "GET" || req.method == "HEAD") && req.path == "/etag") {
+            auto inm = req.headers.find("if-none-match");
+            if (inm != req.headers.end() && inm->second == etag) {
+                resp = httpResponse(304, {{"ETag", etag}}, "", keepAlive);
             } else {
-                auto resp = httpResponse(404, {{"Content-Type", "text/plain"}}, "not found");
-                ::send(c, resp.c_str(), (int)resp.size(), 0);
+                resp = httpResponse(200, {{"Content-Type", "application/json"}, {"ETag", etag}}, R"({"ok":true})",
+                                    keepAlive);
             }
-
-            closesock(c);
+        } else if (req.method == "POST" && req.path == "/post") {
+            {
+                std::lock_guard<std::mutex> g(_mtx);
+                _lastPostBody = req.body;
+            }
+            resp = httpResponse(200, {{"Content-Type", "text/plain"}}, "ok", keepAlive);
+        } else {
+            resp = httpResponse(404, {{"Content-Type", "text/plain"}}, "not found", keepAlive);
         }
+        // A HEAD answer carries the headers of the GET one, without its body.
+        if (req.method == "HEAD")
+            resp.resize(resp.find("\r\n\r\n") + 4);
+        ::send(c, resp.c_str(), (int)resp.size(), 0);
+        return keepAlive;
     }
 
   private:
@@ -307,8 +333,101 @@ class TinyHttpServer {
 
     mutable std::mutex _mtx;
     std::optional<std::string> _lastPostBody;
+    std::vector<std::string> _methods;
+    std::atomic<bool> _keepAlive{false};
+    std::atomic<int> _connections{0};
 };
 
+// Accepts connections (through the listen backlog) but never answers: requests stall until timeout or cancel.
+class SilentServer {
+  public:
+    SilentServer() {
+        _sock = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(0);
+        ::bind(_sock, (sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(_sock, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+        ::listen(_sock, 8);
+    }
+    ~SilentServer() {
+        if (socket_valid(_sock))
+            closesock(_sock);
+    }
+    int port() const {
+        return _port;
+    }
+
+  private:
+    WinsockRAII _wsa;
+    SOCKET _sock{};
+    int _port{0};
+};
+
+#ifndef _WIN32
+#include <sys/un.h>
+
+// Answers every connection on a unix domain socket with one fixed 200 response.
+class UnixSocketServer {
+  public:
+    UnixSocketServer() {
+        _path = "/tmp/unleash-test-" + std::to_string(::getpid()) + ".sock";
+        ::unlink(_path.c_str());
+        _sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, _path.c_str(), sizeof(addr.sun_path) - 1);
+        if (::bind(_sock, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(_sock, 8) != 0)
+            throw std::runtime_error("unix socket bind/listen failed");
+        _thread = std::thread([this] { loop(); });
+    }
+    ~UnixSocketServer() {
+        _running.store(false);
+        ::shutdown(_sock, SHUT_RDWR);
+        if (_thread.joinable())
+            _thread.join();
+        closesock(_sock);
+        ::unlink(_path.c_str());
+    }
+    const std::string& path() const {
+        return _path;
+    }
+    int requests() const {
+        return _requests.load();
+    }
+
+  private:
+    void loop() {
+        while (_running.load()) {
+            SOCKET c = ::accept(_sock, nullptr, nullptr);
+            if (!socket_valid(c))
+                continue;
+            std::string raw;
+            char buf[2048];
+            while (raw.find("\r\n\r\n") == std::string::npos) {
+                const auto n = ::recv(c, buf, sizeof(buf), 0);
+                if (n <= 0)
+                    break;
+                raw.append(buf, buf + n);
+            }
+            ++_requests;
+            auto resp = httpResponse(200, {{"Content-Type", "application/json"}}, R"({"via":"unix"})");
+            ::send(c, resp.c_str(), resp.size(), 0);
+            closesock(c);
+        }
+    }
+
+    std::string _path;
+    SOCKET _sock{};
+    std::atomic<bool> _running{true};
+    std::atomic<int> _requests{0};
+    std::thread _thread;
+};
+#endif
+
 struct DummyRequest : public IComRequest {
     std::string type() const override {
         return "dummy";
@@ -411,3 +530,172 @@ TEST(HttpClient, PostSendsBodyAndServerReceivesIt) {
     ASSERT_TRUE(got.has_value());
     EXPECT_EQ(*got, req.body);
 }
+
+TEST(HttpClient, CancelAndInterruptAbortStalledRequestPromptly) {
+    SilentServer server;
+
+    unleash::HttpClient client;
+    unleash::HttpRequest req;
+    req.url = "http://127.0.0.1:" + std::to_string(server.port()) + "/stall";
+    req.timeoutMs = 5000;
+
+    IComClient::CancelToken cancel{false};
+    std::unique_ptr<IComResponse> respBase;
+    std::chrono::steady_clock::time_point finished;
+    std::thread worker([&] {
+        respBase = client.request(req, &cancel);
+        finished = std::chrono::steady_clock::now();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto cancelled = std::chrono::steady_clock::now();
+    cancel.store(true);
+    client.interrupt();
+    worker.join();
+
+    EXPECT_LT(finished - cancelled, std::chrono::milliseconds(200));
+    auto* resp = dynamic_cast<unleash::HttpResponse*>(respBase.get());
+    ASSERT_NE(resp, nullptr);
+    EXPECT_EQ(resp->status, -1);
+    EXPECT_FALSE(resp->errorMessage.empty());
+}
+
+TEST(HttpClient, CancellableRequestStillCompletes) {
+    TinyHttpServer server;
+
+    unleash::HttpClient client;
+    unleash::HttpRequest req;
+    req.url = "http://127.0.0.1:" + std::to_string(server.port()) + "/etag";
+    req.timeoutMs = 3000;
+
+    IComClient::CancelToken cancel{false};
+    auto respBase = client.request(req, &cancel);
+    auto* resp = dynamic_cast<unleash::HttpResponse*>(respBase.get());
+    ASSERT_NE(resp, nullptr);
+    EXPECT_EQ(resp->status, 200);
+    EXPECT_EQ(resp->body, R"({"ok":true})");
+}
+
+TEST(HttpClient, ReusedClientSwapsIfNoneMatchBetweenRequests) {
+    TinyHttpServer server;
+
+    unleash::HttpClient client;
+    unleash::HttpRequest req;
+    req.url = "http://127.0.0.1:" + std::to_string(server.port()) + "/etag";
+    req.timeoutMs = 3000;
+    req.headers["accept"] = "application/json";
+
+    auto statusOf = [&] {
+        auto respBase = client.request(req);
+        auto* resp = dynamic_cast<unleash::HttpResponse*>(respBase.get());
+        return resp ? resp->status : -2;
+    };
+
+    req.headers["if-none-match"] = R"(W/"old")";
+    EXPECT_EQ(statusOf(), 200);
+
+    req.headers["if-none-match"] = R"(W/"abc")";
+    EXPECT_EQ(statusOf(), 304);
+
+    // Static headers change while the ETag stays:
+    req.headers["x-extra"] = "1";
+    EXPECT_EQ(statusOf(), 304);
+
+    req.headers.erase("if-none-match");
+    EXPECT_EQ(statusOf(), 200);
+}
+
+TEST(HttpClient, KeepsOnlyConsumedHeadersAndReusesRecycledBody) {
+    TinyHttpServer server;
+
+    unleash::HttpClient client;
+    unleash::HttpRequest req;
+    req.url = "http://127.0.0.1:" + std::to_string(server.port()) + "/etag";
+    req.timeoutMs = 3000;
+
+    auto r1 = client.request(req);
+    auto* resp1 = dynamic_cast<unleash::HttpResponse*>(r1.get());
+    ASSERT_NE(resp1, nullptr);
+    ASSERT_EQ(resp1->status, 200);
+    EXPECT_EQ(resp1->headers.count("etag"), 1u);
+    EXPECT_EQ(resp1->headers.count("content-length"), 1u);
+    EXPECT_EQ(resp1->headers.count("content-type"), 0u);
+    EXPECT_EQ(resp1->headers.count("connection"), 0u);
+
+    std::string big;
+    big.reserve(1 << 16);
+    const char* pooled = big.data();
+    client.recycleBody(std::move(big));
+
+    auto r2 = client.request(req);
+    auto* resp2 = dynamic_cast<unleash::HttpResponse*>(r2.get());
+    ASSERT_NE(resp2, nullptr);
+    EXPECT_EQ(resp2->body, R"({"ok":true})");
+    EXPECT_EQ(resp2->body.data(), pooled);
+    EXPECT_GE(resp2->body.capacity(), std::size_t{1 << 16});
+}
+
+TEST(HttpClient, WarmUpSendsHeadThenRequestsKeepTheirMethod) {
+    TinyHttpServer server;
+    server.setKeepAlive(true);
+    {
+        unleash::HttpClient client;
+        unleash::HttpRequest req;
+        req.url = "http://127.0.0.1:" + std::to_string(server.port()) + "/etag";
+        req.timeoutMs = 3000;
+
+        std::string big;
+        big.reserve(1 << 16);
+        const char* pooled = big.data();
+        client.recycleBody(std::move(big));
+
+        EXPECT_TRUE(client.warmUp(req));
+
+        auto respBase = client.request(req);
+        auto* resp = dynamic_cast<unleash::HttpResponse*>(respBase.get());
+        ASSERT_NE(resp, nullptr);
+        EXPECT_EQ(resp->status, 200);
+        EXPECT_EQ(resp->body, R"({"ok":true})");
+        // The pooled buffer survived the warm-up:
+        EXPECT_EQ(resp->body.data(), pooled);
+        EXPECT_EQ(server.methods(), (std::vector<std::string>{"HEAD", "GET"}));
+        // ... and the GET went over the connection the HEAD opened.
+        EXPECT_EQ(server.connections(), 1);
+
+        unleash::HttpRequest unreachable;
+        unreachable.url = "http://127.0.0.1:1/";
+        unreachable.timeoutMs = 1000;
+        EXPECT_FALSE(client.warmUp(unreachable));
+    } // the client closes its connection before the server stops
+}
+
+#ifndef _WIN32
+TEST(HttpClient, UnixSocketPathReplacesTcp) {
+    UnixSocketServer unixServer;
+    TinyHttpServer tcpServer;
+
+    unleash::HttpClient client;
+    unleash::HttpRequest req;
+    // The port is not listened on: only the socket path is used.
+    req.url = "http://localhost:1/etag";
+    req.timeoutMs = 3000;
+    req.unixSocketPath = unixServer.path();
+
+    auto r1 = client.request(req);
+    auto* resp1 = dynamic_cast<unleash::HttpResponse*>(r1.get());
+    ASSERT_NE(resp1, nullptr);
+    EXPECT_EQ(resp1->status, 200);
+    EXPECT_EQ(resp1->body, R"({"via":"unix"})");
+    EXPECT_EQ(unixServer.requests(), 1);
+
+    // Back to TCP on the same client:
+    req.unixSocketPath.clear();
+    req.url = "http://127.0.0.1:" + std::to_string(tcpServer.port()) + "/etag";
+    auto r2 = client.request(req);
+    auto* resp2 = dynamic_cast<unleash::HttpResponse*>(r2.get());
+    ASSERT_NE(resp2, nullptr);
+    EXPECT_EQ(resp2->status, 200);
+    EXPECT_EQ(resp2->body, R"({"ok":true})");
+    EXPECT_EQ(unixServer.requests(), 1);
+}
+#endif
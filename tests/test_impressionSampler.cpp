@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "internal/impressionSampler.hpp"
+
+#include <string>
+
+using namespace unleash;
+
+namespace {
+
+ClientConfig makeConfig() {
+    return ClientConfig("http://127.0.0.1:1", "dummy-key", "sampler-test");
+}
+
+} // namespace
+
+TEST(ImpressionSamplerTest, InactiveByDefaultAdmitsEverything) {
+    auto cfg = makeConfig();
+    ImpressionSampler sampler(cfg);
+    EXPECT_FALSE(sampler.active());
+
+    std::uint64_t suppressed = 42;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(sampler.admit("flag", true, "", suppressed));
+        EXPECT_EQ(suppressed, 0u);
+    }
+}
+
+TEST(ImpressionSamplerTest, ZeroRateDropsAndCountsUntilNextAdmitted) {
+    auto cfg = makeConfig();
+    cfg.setImpressionSampleRate(0.0).setFlagImpressionSampleRate("kept", 1.0);
+    ImpressionSampler sampler(cfg);
+    ASSERT_TRUE(sampler.active());
+
+    std::uint64_t suppressed = 0;
+    for (int i = 0; i < 10; ++i)
+        EXPECT_FALSE(sampler.admit("dropped", true, "", suppressed, 0));
+    EXPECT_TRUE(sampler.admit("kept", true, "", suppressed, 0));
+    EXPECT_EQ(suppressed, 0u);
+}
+
+TEST(ImpressionSamplerTest, PartialRateKeepsRoughlyThatShare) {
+    auto cfg = makeConfig();
+    cfg.setImpressionSampleRate(0.25);
+    ImpressionSampler sampler(cfg);
+
+    int admitted = 0;
+    std::uint64_t suppressedTotal = 0;
+    std::uint64_t suppressed = 0;
+    for (int i = 0; i < 20000; ++i) {
+        if (sampler.admit("flag", true, "", suppressed, 0)) {
+            ++admitted;
+            suppressedTotal += suppressed;
+        }
+    }
+    EXPECT_NEAR(admitted / 20000.0, 0.25, 0.03);
+    // Every impression is either emitted or counted on a later emitted one (up to the trailing dropped ones):
+    EXPECT_LE(admitted + suppressedTotal, 20000u);
+    EXPECT_GT(admitted + suppressedTotal, 19900u);
+}
+
+TEST(ImpressionSamplerTest, FirstNPerIntervalThenCounts) {
+    auto cfg = makeConfig();
+    cfg.setImpressionFirstN(2, utils::mSeconds{1000});
+    ImpressionSampler sampler(cfg);
+
+    std::uint64_t suppressed = 0;
+    EXPECT_TRUE(sampler.admit("flag", true, "", suppressed, 0));
+    EXPECT_TRUE(sampler.admit("flag", false, "", suppressed, 10));
+    EXPECT_FALSE(sampler.admit("flag", true, "", suppressed, 20));
+    EXPECT_FALSE(sampler.admit("flag", true, "", suppressed, 30));
+    // Another flag has its own budget:
+    EXPECT_TRUE(sampler.admit("other", true, "", suppressed, 30));
+
+    EXPECT_TRUE(sampler.admit("flag", true, "", suppressed, 1000));
+    EXPECT_EQ(suppressed, 2u);
+}
+
+TEST(ImpressionSamplerTest, DedupWindowPerFlagEnabledAndVariant) {
+    auto cfg = makeConfig();
+    cfg.setImpressionDedupWindow(utils::mSeconds{100});
+    ImpressionSampler sampler(cfg);
+
+    std::uint64_t suppressed = 0;
+    EXPECT_TRUE(sampler.admit("flag", true, "a", suppressed, 0));
+    EXPECT_FALSE(sampler.admit("flag", true, "a", suppressed, 50));
+    EXPECT_TRUE(sampler.admit("flag", true, "b", suppressed, 50));
+    EXPECT_EQ(suppressed, 1u);
+    EXPECT_TRUE(sampler.admit("flag", false, "a", suppressed, 60));
+    EXPECT_TRUE(sampler.admit("flag", true, "a", suppressed, 100));
+}
+
+TEST(ImpressionSamplerTest, DedupForgetsEmissionsPastTheWindow) {
+    auto cfg = makeConfig();
+    cfg.setImpressionDedupWindow(utils::mSeconds{100});
+    ImpressionSampler sampler(cfg);
+
+    std::uint64_t suppressed = 0;
+    for (int v = 0; v < 50; ++v)
+        EXPECT_TRUE(sampler.admit("flag", true, "v" + std::to_string(v), suppressed, v));
+    EXPECT_EQ(sampler.dedupEntries(), 50u);
+
+    // Every earlier variant is out of the window by now:
+    EXPECT_TRUE(sampler.admit("flag", true, "late", suppressed, 1000));
+    EXPECT_EQ(sampler.dedupEntries(), 1u);
+    EXPECT_FALSE(sampler.admit("flag", true, "late", suppressed, 1050));
+}
+
+TEST(ImpressionSamplerTest, ConfigRejectsRatesOutsideUnitInterval) {
+    auto cfg = makeConfig();
+    EXPECT_TRUE(cfg.isValid());
+    cfg.setFlagImpressionSampleRate("flag", 1.5);
+    EXPECT_FALSE(cfg.isValid());
+}
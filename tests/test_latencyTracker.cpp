@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include "unleash/Fetcher/latencyTracker.hpp"
+
+using namespace unleash;
+using std::chrono::milliseconds;
+
+TEST(LatencyTrackerTest, NoEstimateBeforeEnoughSamples) {
+    LatencyTracker tracker;
+    for (std::size_t i = 1; i < LatencyTracker::minSamples; ++i)
+        tracker.add(milliseconds(10));
+    EXPECT_FALSE(tracker.percentile(0.5).has_value());
+    tracker.add(milliseconds(10));
+    EXPECT_EQ(tracker.percentile(0.5), milliseconds(10));
+    EXPECT_FALSE(tracker.percentile(0.0).has_value());
+}
+
+TEST(LatencyTrackerTest, NearestRankPercentiles) {
+    LatencyTracker tracker;
+    for (int ms = 1; ms <= 100; ++ms)
+        tracker.add(milliseconds(101 - ms));
+    EXPECT_EQ(tracker.count(), 100u);
+    EXPECT_EQ(tracker.percentile(0.5), milliseconds(50));
+    EXPECT_EQ(tracker.percentile(0.95), milliseconds(95));
+    EXPECT_EQ(tracker.percentile(1.0), milliseconds(100));
+    EXPECT_EQ(tracker.percentile(0.001), milliseconds(1));
+}
+
+TEST(LatencyTrackerTest, KeepsOnlyTheLatestWindow) {
+    LatencyTracker tracker;
+    for (std::size_t i = 0; i < LatencyTracker::windowSize; ++i)
+        tracker.add(milliseconds(1000));
+    for (std::size_t i = 0; i < LatencyTracker::windowSize; ++i)
+        tracker.add(milliseconds(5));
+    EXPECT_EQ(tracker.count(), LatencyTracker::windowSize);
+    EXPECT_EQ(tracker.percentile(1.0), milliseconds(5));
+}
@@ -93,3 +93,22 @@ TEST(MetricListTest, AddMetricData_MultipleTogglesAreTrackedIndependently) {
         EXPECT_EQ(stats.at("blue"), 2u);
     }
 }
+
+TEST(MetricListTest, AddCountsMergesIntoExistingAndNewToggles) {
+    MetricList ml;
+    ml.addEnableMetricData("flagA", true);
+
+    ml.addCounts("flagA", 3, 2);
+    ml.addCounts("flagB", 0, 4);
+    ml.addVariantCount("flagB", "v1", 5);
+    ml.addVariantCount("flagC", "v2", 1);
+
+    const auto& m = ml.getList();
+    ASSERT_EQ(m.size(), 3u);
+    EXPECT_EQ(m.at("flagA").getYesCount(), 4u);
+    EXPECT_EQ(m.at("flagA").getNoCount(), 2u);
+    EXPECT_EQ(m.at("flagB").getNoCount(), 4u);
+    EXPECT_EQ(m.at("flagB").getVariantStats().at("v1"), 5u);
+    EXPECT_EQ(m.at("flagC").getYesCount(), 0u);
+    EXPECT_EQ(m.at("flagC").getVariantStats().at("v2"), 1u);
+}
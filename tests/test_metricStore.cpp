@@ -10,6 +10,11 @@
 #include <vector>
 #include <string>
 
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using nlohmann::json;
 using namespace unleash;
 
@@ -181,3 +186,51 @@ TEST(MetricsStoreTest, ThreadSafety_ManyThreadsUpdatingTotalsAreCorrect) {
         EXPECT_EQ(B.getVariantStats().at("v2"), expectedPerFlag);
     }
 }
+
+TEST(MetricsStoreTest, TakeJsonMetricsPayload_ReturnsWindowAndStartsANewOne) {
+    auto cfg = makeCfgForMetrics("unleash-demo2", "browser");
+    MetricsStore store(cfg);
+
+    EXPECT_FALSE(store.takeJsonMetricsPayload().has_value());
+
+    store.addVariantMetric("test-flag", true, "hello");
+    store.addEnableMetric("test-flag", false);
+
+    auto payloadOpt = store.takeJsonMetricsPayload();
+    ASSERT_TRUE(payloadOpt.has_value());
+    json j = parsePayload(*payloadOpt);
+    EXPECT_EQ(j["bucket"]["toggles"]["test-flag"]["yes"], 1);
+    EXPECT_EQ(j["bucket"]["toggles"]["test-flag"]["no"], 1);
+
+    EXPECT_TRUE(store.empty());
+    EXPECT_FALSE(store.takeJsonMetricsPayload().has_value());
+}
+
+#if !defined(_WIN32)
+TEST(MetricsStoreTest, ForkHooks_ChildStartsEmptyWindowParentKeepsCounts) {
+    auto cfg = makeCfgForMetrics("unleash-demo2", "browser");
+    MetricsStore store(cfg);
+    store.addEnableMetric("test-flag", true);
+
+    store.prepareFork();
+    const pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        store.childAfterFork();
+        const bool emptyWindow = store.empty() && !store.takeJsonMetricsPayload().has_value();
+        store.addEnableMetric("child-flag", true);
+        ::_exit(emptyWindow && !store.empty() ? 0 : 1);
+    }
+    store.parentAfterFork();
+
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    auto payloadOpt = store.takeJsonMetricsPayload();
+    ASSERT_TRUE(payloadOpt.has_value());
+    json j = parsePayload(*payloadOpt);
+    EXPECT_EQ(j["bucket"]["toggles"]["test-flag"]["yes"], 1);
+}
+#endif
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "internal/pollBackoff.hpp"
+
+#include <algorithm>
+
+using namespace unleash;
+using std::chrono::milliseconds;
+
+namespace {
+
+ClientConfig makeConfig() {
+    ClientConfig cfg("http://127.0.0.1:1", "dummy-key", "backoff-test");
+    cfg.setRefreshInterval(utils::seconds{10}).setPollBackoffMax(utils::seconds{120});
+    return cfg;
+}
+
+} // namespace
+
+TEST(PollBackoffTest, SuccessPollsAtTheRefreshInterval) {
+    PollBackoff backoff(makeConfig(), 1);
+    EXPECT_EQ(backoff.onSuccess(), milliseconds(10000));
+    EXPECT_EQ(backoff.failures(), 0u);
+    EXPECT_EQ(backoff.startupDelay(), milliseconds(0));
+}
+
+TEST(PollBackoffTest, FailuresStayWithinTheGrowingCeilingAndTheMax) {
+    PollBackoff backoff(makeConfig(), 42);
+    for (unsigned failure = 1; failure <= 10; ++failure) {
+        const auto delay = backoff.onFailure();
+        const auto ceiling = std::min<long long>(10000LL << failure, 120000);
+        EXPECT_GE(delay, milliseconds(10000)) << failure;
+        EXPECT_LE(delay.count(), ceiling) << failure;
+    }
+    EXPECT_EQ(backoff.failures(), 10u);
+
+    // Back to the normal interval after one success:
+    EXPECT_EQ(backoff.onSuccess(), milliseconds(10000));
+    EXPECT_EQ(backoff.failures(), 0u);
+}
+
+TEST(PollBackoffTest, JitterSpreadsDelays) {
+    PollBackoff backoff(makeConfig(), 7);
+    for (int i = 0; i < 4; ++i)
+        backoff.onFailure();
+    milliseconds minDelay(120000);
+    milliseconds maxDelay(0);
+    for (int i = 0; i < 50; ++i) {
+        const auto delay = backoff.onFailure();
+        minDelay = std::min(minDelay, delay);
+        maxDelay = std::max(maxDelay, delay);
+    }
+    EXPECT_LT(minDelay, maxDelay);
+}
+
+TEST(PollBackoffTest, FirstFailuresDoNotPileUpOnTheInterval) {
+    // A draw clamped up to the interval would land there half of the time after the first failure:
+    PollBackoff backoff(makeConfig(), 11);
+    int atInterval = 0;
+    for (int i = 0; i < 1000; ++i) {
+        if (backoff.onFailure() == milliseconds(10000))
+            ++atInterval;
+        backoff.onSuccess();
+    }
+    EXPECT_LT(atInterval, 10);
+}
+
+TEST(PollBackoffTest, RetryAfterIsAFloorUpToTheMax) {
+    PollBackoff backoff(makeConfig(), 3);
+    EXPECT_GE(backoff.onFailure(milliseconds(90000)), milliseconds(90000));
+    EXPECT_GE(backoff.onFailure(milliseconds(1)), milliseconds(10000));
+}
+
+TEST(PollBackoffTest, RetryAfterIsClampedToTheMax) {
+    PollBackoff backoff(makeConfig(), 3);
+    EXPECT_EQ(backoff.onFailure(milliseconds(600000)), milliseconds(120000));
+    // e.g. an HTTP-date years ahead:
+    EXPECT_EQ(backoff.onFailure(milliseconds(std::chrono::hours(24 * 365 * 5))), milliseconds(120000));
+}
+
+TEST(PollBackoffTest, StartupDelayIsWithinTheJitter) {
+    auto cfg = makeConfig();
+    cfg.setPollStartupJitter(milliseconds(500));
+    PollBackoff backoff(cfg, 11);
+    bool nonZero = false;
+    for (int i = 0; i < 20; ++i) {
+        const auto delay = backoff.startupDelay();
+        EXPECT_GE(delay, milliseconds(0));
+        EXPECT_LE(delay, milliseconds(500));
+        nonZero = nonZero || delay.count() > 0;
+    }
+    EXPECT_TRUE(nonZero);
+}
+
+TEST(PollBackoffTest, MaxBelowTheIntervalNeverShortensIt) {
+    auto cfg = makeConfig();
+    cfg.setPollBackoffMax(utils::seconds{1});
+    PollBackoff backoff(cfg, 5);
+    EXPECT_EQ(backoff.onFailure(), milliseconds(10000));
+}
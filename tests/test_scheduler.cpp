@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include "unleash/EventHandler/eventHandler.hpp"
+#include "unleash/Scheduler/scheduler.hpp"
+#include "internal/taskGuard.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace unleash;
+
+namespace {
+
+bool waitUntil(const std::function<bool()>& predicate, std::chrono::milliseconds timeout = 1s) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(ThreadSchedulerTest, RunsTasksInDueOrder) {
+    ThreadScheduler scheduler;
+    std::mutex m;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value] {
+            std::lock_guard<std::mutex> lk(m);
+            order.push_back(value);
+        };
+    };
+
+    scheduler.postAfter(60ms, record(3));
+    scheduler.postAfter(30ms, record(2));
+    scheduler.post(record(1));
+
+    ASSERT_TRUE(waitUntil([&] {
+        std::lock_guard<std::mutex> lk(m);
+        return order.size() == 3;
+    }));
+    std::lock_guard<std::mutex> lk(m);
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(ThreadSchedulerTest, CancelledTaskDoesNotRun) {
+    ThreadScheduler scheduler;
+    std::atomic<int> runs{0};
+
+    const auto id = scheduler.postAfter(50ms, [&] { runs.fetch_add(1); });
+    EXPECT_TRUE(scheduler.cancel(id));
+    EXPECT_FALSE(scheduler.cancel(id));
+
+    std::atomic<bool> done{false};
+    scheduler.postAfter(80ms, [&] { done = true; });
+    ASSERT_TRUE(waitUntil([&] { return done.load(); }));
+    EXPECT_EQ(runs.load(), 0);
+}
+
+TEST(TaskGuardTest, CloseSkipsPendingAndWaitsForRunningTasks) {
+    ThreadScheduler scheduler;
+    TaskGuard guard;
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    std::atomic<int> skippedRuns{0};
+
+    scheduler.post(guard.wrap([&] {
+        started = true;
+        std::this_thread::sleep_for(50ms);
+        finished = true;
+    }));
+    scheduler.postAfter(20ms, guard.wrap([&] { skippedRuns.fetch_add(1); }));
+
+    ASSERT_TRUE(waitUntil([&] { return started.load(); }));
+    guard.close();
+    EXPECT_TRUE(finished.load());
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(skippedRuns.load(), 0);
+}
+
+TEST(TaskGuardTest, WrapRacesWithReopening) {
+    TaskGuard guard;
+    std::atomic<bool> stop{false};
+    std::atomic<int> runs{0};
+
+    // Emitters wrap tasks on their own threads while the owner restarts:
+    std::thread emitter([&] {
+        while (!stop.load())
+            guard.wrap([&] { runs.fetch_add(1); })();
+    });
+    for (int i = 0; i < 1000; ++i) {
+        guard.close();
+        guard.open();
+    }
+    stop = true;
+    emitter.join();
+
+    guard.wrap([&] { runs.fetch_add(1); })();
+    EXPECT_GT(runs.load(), 0);
+}
+
+TEST(EventHandlerSchedulerTest, CallbacksRunOnTheScheduler) {
+    auto scheduler = std::make_shared<ThreadScheduler>();
+    std::thread::id schedulerThread;
+    std::atomic<bool> known{false};
+    scheduler->post([&] {
+        schedulerThread = std::this_thread::get_id();
+        known = true;
+    });
+    ASSERT_TRUE(waitUntil([&] { return known.load(); }));
+
+    EventHandler eh(16, EventOverflowPolicy::DropNewest, utils::eventBlockTimeout, scheduler);
+    eh.start();
+
+    std::mutex m;
+    std::vector<std::thread::id> callbackThreads;
+    eh.onUpdate([&] {
+        std::lock_guard<std::mutex> lk(m);
+        callbackThreads.push_back(std::this_thread::get_id());
+    });
+    for (int i = 0; i < 5; ++i)
+        eh.emitUpdate();
+
+    ASSERT_TRUE(waitUntil([&] {
+        std::lock_guard<std::mutex> lk(m);
+        return callbackThreads.size() == 5;
+    }));
+    eh.stop();
+
+    for (const auto& id : callbackThreads)
+        EXPECT_EQ(id, schedulerThread);
+}
+
+TEST(EventHandlerSchedulerTest, ImpressionBatchDelayUsesSchedulerTimer) {
+    auto scheduler = std::make_shared<ThreadScheduler>();
+    EventHandler eh(16, EventOverflowPolicy::DropNewest, utils::eventBlockTimeout, scheduler);
+    eh.start();
+
+    std::atomic<std::size_t> delivered{0};
+    eh.onImpressionBatch([&](const std::vector<ClientImpression>& batch) { delivered += batch.size(); }, 10, 30ms);
+    eh.emitImpression(ClientImpression{std::make_shared<const Context>("app"), "a", true, "isEnabled", false});
+
+    ASSERT_TRUE(waitUntil([&] { return delivered.load() == 1; }));
+    eh.stop();
+}
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unleash/Configuration/clientConfig.hpp"
+#include "unleash/Metrics/metricStore.hpp"
+#include "unleash/Metrics/sharedMetricsSegment.hpp"
+
+#include <nlohmann/json.hpp>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using nlohmann::json;
+using namespace unleash;
+
+namespace {
+
+struct SegmentName {
+    std::string name;
+
+    SegmentName() {
+        const auto ts = std::chrono::steady_clock::now().time_since_epoch().count();
+#if defined(_WIN32)
+        name = "unleash-metrics-test-" + std::to_string(ts);
+#else
+        name = "unleash-metrics-test-" + std::to_string(::getpid()) + "-" + std::to_string(ts);
+#endif
+    }
+
+    ~SegmentName() {
+        SharedMetricsSegment::remove(name);
+    }
+};
+
+} // namespace
+
+#if !defined(_WIN32)
+
+TEST(SharedMetricsSegment, DrainMergesEnableAndVariantCounts) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 4, 64);
+    ASSERT_NE(segment, nullptr);
+
+    segment->addEnableMetric("flagA", true);
+    segment->addEnableMetric("flagA", false);
+    segment->addVariantMetric("flagB", true, "v1");
+    segment->addVariantMetric("flagB", true, "v1");
+    segment->addVariantMetric("flagB", false, "v2");
+
+    std::int64_t startMs = 0;
+    MetricList list = segment->drain(startMs);
+    EXPECT_GT(startMs, 0);
+
+    const auto& m = list.getList();
+    ASSERT_EQ(m.size(), 2u);
+    EXPECT_EQ(m.at("flagA").getYesCount(), 1u);
+    EXPECT_EQ(m.at("flagA").getNoCount(), 1u);
+    EXPECT_EQ(m.at("flagB").getYesCount(), 2u);
+    EXPECT_EQ(m.at("flagB").getNoCount(), 1u);
+    EXPECT_EQ(m.at("flagB").getVariantStats().at("v1"), 2u);
+    EXPECT_EQ(m.at("flagB").getVariantStats().at("v2"), 1u);
+
+    // Drain resets the counters.
+    EXPECT_TRUE(segment->drain(startMs).empty());
+}
+
+TEST(SharedMetricsSegment, CountsFromSeveralHandlesAreAggregated) {
+    SegmentName seg;
+    auto first = SharedMetricsSegment::attach(seg.name, 4, 64);
+    auto second = SharedMetricsSegment::attach(seg.name);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    first->addEnableMetric("flagA", true);
+    second->addEnableMetric("flagA", true);
+    second->addEnableMetric("flagB", false);
+
+    std::int64_t startMs = 0;
+    MetricList list = first->drain(startMs);
+    const auto& m = list.getList();
+    ASSERT_EQ(m.size(), 2u);
+    EXPECT_EQ(m.at("flagA").getYesCount(), 2u);
+    EXPECT_EQ(m.at("flagB").getNoCount(), 1u);
+}
+
+TEST(SharedMetricsSegment, ForkedWorkersReportThroughOneSegment) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 8, 64);
+    ASSERT_NE(segment, nullptr);
+
+    constexpr int kChildren = 3;
+    for (int i = 0; i < kChildren; ++i) {
+        const pid_t pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            const bool ok = segment->registerWorker();
+            for (int n = 0; n < 100; ++n)
+                segment->addEnableMetric("flagA", true);
+            ::_exit(ok ? 0 : 1);
+        }
+        int status = 0;
+        ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+
+    std::int64_t startMs = 0;
+    MetricList list = segment->drain(startMs);
+    ASSERT_EQ(list.getList().size(), 1u);
+    EXPECT_EQ(list.getList().at("flagA").getYesCount(), 100u * kChildren);
+}
+
+TEST(SharedMetricsSegment, LeaseIsHeldByOneProcessUntilItExpires) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 4, 16);
+    ASSERT_NE(segment, nullptr);
+
+    EXPECT_TRUE(segment->tryLead(std::chrono::seconds{60}));
+    // Renewal by the holder.
+    EXPECT_TRUE(segment->tryLead(std::chrono::seconds{60}));
+
+    const pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        ::_exit(segment->tryLead(std::chrono::seconds{60}) ? 1 : 0);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0) << "Another process took a lease that had not expired";
+}
+
+TEST(SharedMetricsSegment, TooLongNamesAndFullSlotsAreCountedAsDropped) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 2, 1);
+    ASSERT_NE(segment, nullptr);
+
+    segment->addEnableMetric(std::string(SharedMetricsSegment::maxNameLength + 1, 'x'), true);
+    segment->addEnableMetric("flagA", true);
+    segment->addEnableMetric("flagB", true);
+
+    EXPECT_EQ(segment->droppedCount(), 2u);
+}
+
+TEST(SharedMetricsSegment, FullTableNeverClaimsSlotsPastItsSize) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 2, 1);
+    ASSERT_NE(segment, nullptr);
+
+    segment->addEnableMetric("flagA", true);
+    for (int i = 0; i < 1000; ++i)
+        segment->addEnableMetric("flagB", true);
+    EXPECT_EQ(segment->slotCount(), 1u);
+    EXPECT_EQ(segment->droppedCount(), 1000u);
+
+    // A handle without the cached miss does not get a slot either:
+    auto other = SharedMetricsSegment::attach(seg.name);
+    ASSERT_NE(other, nullptr);
+    other->addEnableMetric("flagB", true);
+    EXPECT_EQ(segment->slotCount(), 1u);
+
+    std::int64_t startMs = 0;
+    MetricList list = segment->drain(startMs);
+    ASSERT_EQ(list.getList().size(), 1u);
+    EXPECT_EQ(list.getList().begin()->first, "flagA");
+}
+
+TEST(SharedMetricsSegment, ConcurrentEvaluationsAreAllCounted) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 4, 64);
+    ASSERT_NE(segment, nullptr);
+
+    ClientConfig cfg("http://127.0.0.1:1", "dummy-key", "shared-app");
+    cfg.setSharedMetricsSegment(segment);
+    MetricsStore store(cfg);
+
+    constexpr int threads = 4;
+    constexpr int perThread = 5000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&store, t] {
+            for (int i = 0; i < perThread; ++i)
+                store.addVariantMetric("flag-" + std::to_string(i % 8), (i + t) % 2 == 0, "v" + std::to_string(i % 3));
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+
+    auto payload = store.takeJsonMetricsPayload(std::chrono::seconds{60});
+    ASSERT_TRUE(payload.has_value());
+    json toggles = json::parse(*payload)["bucket"]["toggles"];
+    int total = 0;
+    int variants = 0;
+    for (auto& [name, counts] : toggles.items()) {
+        total += counts["yes"].get<int>() + counts["no"].get<int>();
+        for (auto& [variant, hits] : counts["variants"].items())
+            variants += hits.get<int>();
+    }
+    EXPECT_EQ(total, threads * perThread);
+    EXPECT_EQ(variants, threads * perThread);
+    EXPECT_EQ(segment->droppedCount(), 0u);
+}
+
+TEST(SharedMetricsSegment, MetricsStoreOnlyProducesPayloadForLeaseHolder) {
+    SegmentName seg;
+    auto segment = SharedMetricsSegment::attach(seg.name, 4, 64);
+    ASSERT_NE(segment, nullptr);
+
+    ClientConfig cfg("http://127.0.0.1:1", "dummy-key", "shared-app");
+    cfg.setInstanceId("host-1").setSharedMetricsSegment(segment);
+    MetricsStore store(cfg);
+
+    store.addVariantMetric("flagA", true, "v1");
+    store.addEnableMetric("flagA", false);
+
+    auto payload = store.takeJsonMetricsPayload(std::chrono::seconds{60});
+    ASSERT_TRUE(payload.has_value());
+    json j = json::parse(*payload);
+    EXPECT_EQ(j["appName"], "shared-app");
+    EXPECT_EQ(j["bucket"]["toggles"]["flagA"]["yes"], 1);
+    EXPECT_EQ(j["bucket"]["toggles"]["flagA"]["no"], 1);
+    EXPECT_EQ(j["bucket"]["toggles"]["flagA"]["variants"]["v1"], 1);
+
+    // Nothing left in the window.
+    EXPECT_FALSE(store.takeJsonMetricsPayload(std::chrono::seconds{60}).has_value());
+}
+
+#else
+
+TEST(SharedMetricsSegment, UnavailableOnWindows) {
+    SegmentName seg;
+    EXPECT_EQ(SharedMetricsSegment::attach(seg.name), nullptr);
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unleash/Domain/toggle.hpp"
+#include "unleash/Domain/toggleSet.hpp"
+#include "unleash/Store/flagStore.hpp"
+#include "unleash/Store/sharedToggleSegment.hpp"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace unleash;
+
+namespace {
+
+struct SegmentName {
+    std::string name;
+
+    SegmentName() {
+        const auto ts = std::chrono::steady_clock::now().time_since_epoch().count();
+#if defined(_WIN32)
+        name = "unleash-test-" + std::to_string(ts);
+#else
+        name = "unleash-test-" + std::to_string(::getpid()) + "-" + std::to_string(ts);
+#endif
+    }
+
+    ~SegmentName() {
+        SharedToggleSegment::remove(name);
+    }
+};
+
+ToggleSet makeSet(const std::string& name, bool enabled) {
+    ToggleSet::Map m;
+    m.emplace(name, Toggle{name, enabled, false});
+    return ToggleSet(std::move(m));
+}
+
+} // namespace
+
+#if !defined(_WIN32)
+
+TEST(SharedToggleSegment, OpenReturnsNullWhenSegmentDoesNotExist) {
+    SegmentName seg;
+    EXPECT_EQ(SharedToggleSegment::open(seg.name), nullptr);
+}
+
+TEST(SharedToggleSegment, ReaderSeesPublishedSnapshots) {
+    SegmentName seg;
+    auto publisher = SharedToggleSegment::create(seg.name, 64 * 1024);
+    ASSERT_NE(publisher, nullptr);
+    EXPECT_TRUE(publisher->isPublisher());
+
+    auto reader = SharedToggleSegment::open(seg.name);
+    ASSERT_NE(reader, nullptr);
+    EXPECT_FALSE(reader->isPublisher());
+    EXPECT_EQ(reader->capacity(), 64u * 1024u);
+
+    EXPECT_EQ(reader->generation(), 0u);
+    EXPECT_FALSE(reader->read().has_value());
+
+    ASSERT_TRUE(publisher->publish(makeSet("flag-a", true)));
+    EXPECT_EQ(reader->generation(), 1u);
+    auto first = reader->read();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->generation, 1u);
+    EXPECT_TRUE(first->toggles.isEnabled("flag-a"));
+
+    ASSERT_TRUE(publisher->publish(makeSet("flag-b", false)));
+    auto second = reader->read();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->generation, 2u);
+    EXPECT_TRUE(second->toggles.contains("flag-b"));
+    EXPECT_FALSE(second->toggles.contains("flag-a"));
+}
+
+TEST(SharedToggleSegment, ReaderCannotPublish) {
+    SegmentName seg;
+    auto publisher = SharedToggleSegment::create(seg.name, 4096);
+    ASSERT_NE(publisher, nullptr);
+    auto reader = SharedToggleSegment::open(seg.name);
+    ASSERT_NE(reader, nullptr);
+
+    EXPECT_FALSE(reader->publish(makeSet("flag-a", true)));
+    EXPECT_EQ(reader->generation(), 0u);
+}
+
+TEST(SharedToggleSegment, PublishFailsWhenSnapshotExceedsCapacity) {
+    SegmentName seg;
+    auto publisher = SharedToggleSegment::create(seg.name, 16);
+    ASSERT_NE(publisher, nullptr);
+
+    EXPECT_FALSE(publisher->publish(makeSet("a-flag-name-that-does-not-fit", true)));
+    EXPECT_EQ(publisher->generation(), 0u);
+}
+
+TEST(SharedToggleSegment, RestartedPublisherKeepsCompatibleSegment) {
+    SegmentName seg;
+    {
+        auto publisher = SharedToggleSegment::create(seg.name, 4096);
+        ASSERT_NE(publisher, nullptr);
+        ASSERT_TRUE(publisher->publish(makeSet("flag-a", true)));
+    }
+    auto publisher = SharedToggleSegment::create(seg.name, 4096);
+    ASSERT_NE(publisher, nullptr);
+    EXPECT_EQ(publisher->generation(), 1u);
+    auto snapshot = publisher->read();
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_TRUE(snapshot->toggles.isEnabled("flag-a"));
+}
+
+TEST(SharedToggleSegment, ConcurrentReadersNeverObserveTornSnapshots) {
+    SegmentName seg;
+    auto publisher = SharedToggleSegment::create(seg.name, 64 * 1024);
+    ASSERT_NE(publisher, nullptr);
+    auto reader = SharedToggleSegment::open(seg.name);
+    ASSERT_NE(reader, nullptr);
+    ASSERT_TRUE(publisher->publish(makeSet("flag-0", true)));
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> invalid{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto snapshot = reader->read();
+                if (!snapshot.has_value() || snapshot->toggles.size() != 1)
+                    invalid.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (int i = 1; i < 2000; ++i)
+        publisher->publish(makeSet("flag-" + std::to_string(i), (i % 2) == 0));
+
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : readers)
+        t.join();
+
+    EXPECT_EQ(invalid.load(), 0);
+}
+
+TEST(SharedToggleSegment, AttachedFlagStoreFollowsPublishedGenerations) {
+    SegmentName seg;
+    auto publisher = SharedToggleSegment::create(seg.name, 4096);
+    ASSERT_NE(publisher, nullptr);
+
+    FlagStore store;
+    int refreshes = 0;
+    store.attach(SharedToggleSegment::open(seg.name), [&] { ++refreshes; });
+
+    EXPECT_FALSE(store.isReady());
+
+    // Reads never decode, only refresh() does:
+    ASSERT_TRUE(publisher->publish(makeSet("flag-a", true)));
+    EXPECT_FALSE(store.isReady());
+    store.refresh();
+    EXPECT_TRUE(store.isReady());
+    EXPECT_TRUE(store.snapshot()->isEnabled("flag-a"));
+    EXPECT_EQ(refreshes, 1);
+
+    // Unchanged generation: same snapshot, no refresh.
+    auto same = store.snapshot();
+    store.refresh();
+    EXPECT_EQ(same, store.snapshot());
+    EXPECT_EQ(refreshes, 1);
+
+    ASSERT_TRUE(publisher->publish(makeSet("flag-a", false)));
+    EXPECT_TRUE(store.snapshot()->isEnabled("flag-a"));
+    store.refresh();
+    EXPECT_FALSE(store.snapshot()->isEnabled("flag-a"));
+    EXPECT_EQ(refreshes, 2);
+}
+
+TEST(SharedToggleSegment, ExplicitRefreshRunsTheCallbackBeforeAnyRead) {
+    SegmentName seg;
+    auto publisher = SharedToggleSegment::create(seg.name, 4096);
+    ASSERT_NE(publisher, nullptr);
+
+    FlagStore store;
+    int refreshes = 0;
+    store.attach(SharedToggleSegment::open(seg.name), [&] { ++refreshes; });
+
+    store.refresh();
+    EXPECT_EQ(refreshes, 0);
+
+    ASSERT_TRUE(publisher->publish(makeSet("flag-a", true)));
+    store.refresh();
+    EXPECT_EQ(refreshes, 1);
+    EXPECT_TRUE(store.isReady());
+    EXPECT_EQ(refreshes, 1);
+}
+
+#else
+
+TEST(SharedToggleSegment, UnavailableOnWindows) {
+    SegmentName seg;
+    EXPECT_EQ(SharedToggleSegment::create(seg.name, 4096), nullptr);
+}
+
+#endif
@@ -59,6 +59,7 @@ struct WsaGuard {
 #include <sys/socket.h>
 #include <unistd.h>
 #include <errno.h>
+#include <csignal>
 
 using socket_t = int;
 static constexpr socket_t kInvalidSocket = -1;
@@ -180,6 +181,10 @@ class MiniHttpServer {
     MiniHttpServer() {
 #ifdef _WIN32
         _wsa.emplace();
+#endif
+#ifndef _WIN32
+        // A delayed response may be written to a connection the client already dropped.
+        std::signal(SIGPIPE, SIG_IGN);
 #endif
         _listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
         if (_listenFd == kInvalidSocket)
@@ -239,6 +244,21 @@ class MiniHttpServer {
         _force500Next.store(v);
     }
 
+    // Every response waits this long (latency injection).
+    void setResponseDelay(std::chrono::milliseconds delay) {
+        _responseDelayMs.store(delay.count());
+    }
+
+    // After the delay, connections are closed without an answer (transport error on the client side).
+    void setDropResponses(bool v) {
+        _dropResponses.store(v);
+    }
+
+    void setForce429OnNext(const std::string& retryAfter) {
+        std::lock_guard<std::mutex> lk(_obsMutex);
+        _force429RetryAfter = retryAfter;
+    }
+
   private:
     // -----------------------------------------------------------------------
     void loop() {
@@ -290,6 +310,30 @@ class MiniHttpServer {
                 }
             }
 
+            const auto delayUntil =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(_responseDelayMs.load());
+            while (!_stop.load() && std::chrono::steady_clock::now() < delayUntil)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+            if (_dropResponses.load()) {
+                socket_shutdown(cfd);
+                socket_close(cfd);
+                continue;
+            }
+
+            std::optional<std::string> retryAfter;
+            {
+                std::lock_guard<std::mutex> lk(_obsMutex);
+                retryAfter = std::exchange(_force429RetryAfter, std::nullopt);
+            }
+            if (retryAfter) {
+                sendResponse(cfd, 429, "Too Many Requests", "text/plain", "slow down", std::nullopt,
+                             "Retry-After: " + *retryAfter + "\r\n");
+                socket_shutdown(cfd);
+                socket_close(cfd);
+                continue;
+            }
+
             if (_force500Next.exchange(false)) {
                 sendResponse(cfd, 500, "Internal Server Error", "text/plain", "boom", std::nullopt);
                 socket_shutdown(cfd);
@@ -388,10 +432,12 @@ class MiniHttpServer {
     }
 
     static void sendResponse(socket_t fd, int status, const std::string& statusText, const std::string& contentType,
-                             const std::string& body, const std::optional<std::string>& etag) {
+                             const std::string& body, const std::optional<std::string>& etag,
+                             const std::string& extraHeaders = std::string()) {
         std::ostringstream oss;
         oss << "HTTP/1.1 " << status << " " << statusText << "\r\n";
         oss << "Connection: close\r\n";
+        oss << extraHeaders;
         if (etag)
             oss << "ETag: " << *etag << "\r\n";
         oss << "Content-Type: " << contentType << "\r\n";
@@ -407,6 +453,9 @@ class MiniHttpServer {
     std::thread _thread;
     std::atomic<bool> _stop{false};
     std::atomic<bool> _force500Next{false};
+    std::atomic<long long> _responseDelayMs{0};
+    std::atomic<bool> _dropResponses{false};
+    std::optional<std::string> _force429RetryAfter; // guarded by _obsMutex
     Observations _obs{};
     mutable std::mutex _obsMutex;
 
@@ -506,3 +555,225 @@ TEST(ToggleFetcher, GetRequestIncludesContextAsQueryParams) {
     EXPECT_NE(line.find("properties%5Bplan%5D=pro"), std::string::npos);
     EXPECT_NE(line.find("properties%5Bnote%5D=hello%20world"), std::string::npos);
 }
+
+TEST(ToggleFetcher, EncodedContextIsReusedUntilTheContextChanges) {
+    MiniHttpServer server;
+
+    const std::string baseUrl = "http://127.0.0.1:" + std::to_string(server.port());
+    unleash::ClientConfig cfg(baseUrl, "dummy-client-key", "unitApp");
+
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    ctx.setUserId("user-1");
+
+    unleash::ToggleFetcher fetcher(cfg);
+    fetcher.fetch(ctx);
+    const std::string firstUrl = fetcher.getHttpRequest().url;
+    const char* firstBuffer = fetcher.getHttpRequest().url.data();
+
+    // Same context (even as another object): the cached query is kept as is.
+    unleash::Context same("unitApp", "dev", "sess-1");
+    same.setUserId("user-1");
+    fetcher.fetch(same);
+    EXPECT_EQ(fetcher.getHttpRequest().url, firstUrl);
+    EXPECT_EQ(fetcher.getHttpRequest().url.data(), firstBuffer);
+
+    unleash::MutableContext mCtx;
+    mCtx.setUserId("user-2");
+    ctx.updateMutableContext(mCtx);
+    fetcher.fetch(ctx);
+    const std::string line = server.lastRequestLine();
+    EXPECT_NE(line.find("appName=unitApp"), std::string::npos);
+    EXPECT_NE(line.find("sessionId=sess-1"), std::string::npos);
+    EXPECT_NE(line.find("userId=user-2"), std::string::npos);
+    EXPECT_EQ(line.find("user-1"), std::string::npos);
+}
+
+TEST(ToggleFetcher, ContextsThatHashAlikeAreStillEncodedApart) {
+    MiniHttpServer server;
+
+    const std::string baseUrl = "http://127.0.0.1:" + std::to_string(server.port());
+    unleash::ClientConfig cfg(baseUrl, "dummy-client-key", "unitApp");
+
+    // Same bytes once the static fields are joined with '\0': equal hashes, different requests.
+    unleash::Context first(std::string("a\0b", 3), "dev", "c");
+    unleash::Context second("a", "dev", std::string("b\0c", 3));
+
+    unleash::ToggleFetcher fetcher(cfg);
+    fetcher.fetch(first);
+    EXPECT_NE(server.lastRequestLine().find("appName=a%00b&sessionId=c"), std::string::npos);
+    fetcher.fetch(second);
+    EXPECT_NE(server.lastRequestLine().find("appName=a&sessionId=b%00c"), std::string::npos);
+}
+
+TEST(ToggleFetcher, Fetch429ReportsRetryAfter) {
+    MiniHttpServer server;
+
+    const std::string baseUrl = "http://127.0.0.1:" + std::to_string(server.port());
+    unleash::ClientConfig cfg(baseUrl, "dummy-client-key", "unitApp");
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    server.setForce429OnNext("120");
+    auto r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.status, 429);
+    EXPECT_TRUE(r.error.has_value());
+    ASSERT_TRUE(r.retryAfter.has_value());
+    EXPECT_EQ(*r.retryAfter, std::chrono::milliseconds(120000));
+
+    // HTTP-date in the past: retry right away.
+    server.setForce429OnNext("Wed, 21 Oct 2015 07:28:00 GMT");
+    r = fetcher.fetch(ctx);
+    ASSERT_TRUE(r.retryAfter.has_value());
+    EXPECT_EQ(*r.retryAfter, std::chrono::milliseconds(0));
+
+    r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.status, 200);
+    EXPECT_FALSE(r.retryAfter.has_value());
+}
+
+TEST(ToggleFetcher, TransportErrorFailsOverToTheNextEndpoint) {
+    MiniHttpServer server;
+
+    const std::string liveUrl = "http://127.0.0.1:" + std::to_string(server.port());
+    unleash::ClientConfig cfg(liveUrl, "dummy-client-key", "unitApp");
+    cfg.setUrls({"http://127.0.0.1:1", liveUrl});
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    ctx.setUserId("user-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    auto r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.status, 200);
+    EXPECT_FALSE(r.error.has_value());
+    EXPECT_EQ(r.endpoint, 1u);
+    EXPECT_NE(server.lastRequestLine().find("userId=user-1"), std::string::npos);
+    EXPECT_EQ(fetcher.endpoints().stats(0).consecutiveFailures, 1u);
+    EXPECT_TRUE(fetcher.endpoints().stats(1).measured);
+
+    // The failed endpoint is cooling down: the next fetch goes straight to the live one.
+    r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.endpoint, 1u);
+    EXPECT_EQ(fetcher.endpoints().stats(0).consecutiveFailures, 1u);
+}
+
+TEST(ToggleFetcher, SlowFetchIsHedgedOnTheOtherEndpoint) {
+    MiniHttpServer slow;
+    MiniHttpServer fast;
+    slow.setResponseDelay(std::chrono::milliseconds(1500));
+
+    const std::string slowUrl = "http://127.0.0.1:" + std::to_string(slow.port());
+    const std::string fastUrl = "http://127.0.0.1:" + std::to_string(fast.port());
+    unleash::ClientConfig cfg(slowUrl, "dummy-client-key", "unitApp");
+    cfg.setUrls({slowUrl, fastUrl}).setFetchHedging(0.95, std::chrono::milliseconds(50));
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    ctx.setUserId("user-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    const auto started = std::chrono::steady_clock::now();
+    auto r = fetcher.fetch(ctx);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    EXPECT_EQ(r.status, 200);
+    ASSERT_TRUE(r.toggles.has_value());
+    EXPECT_TRUE(r.hedged);
+    EXPECT_EQ(r.endpoint, 1u);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000)); // the slow request was cancelled, not waited for
+    EXPECT_NE(fast.lastRequestLine().find("userId=user-1"), std::string::npos);
+    // The slow endpoint is known to take at least the hedge delay now: the next fetch starts on the fast one.
+    EXPECT_GE(fetcher.endpoints().stats(0).latencyMs, 50.0);
+    r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.endpoint, 1u);
+    EXPECT_FALSE(r.hedged);
+}
+
+TEST(ToggleFetcher, FastFetchIsNotHedged) {
+    MiniHttpServer server;
+
+    const std::string baseUrl = "http://127.0.0.1:" + std::to_string(server.port());
+    unleash::ClientConfig cfg(baseUrl, "dummy-client-key", "unitApp");
+    cfg.setFetchHedging(0.95, std::chrono::milliseconds(2000));
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    auto r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.status, 200);
+    EXPECT_FALSE(r.hedged);
+    EXPECT_EQ(server.obs().requests.load(), 1);
+    EXPECT_EQ(fetcher.latencies().count(), 1u);
+}
+
+TEST(ToggleFetcher, PrimaryFailingWhileTheHedgeIsInFlightDoesNotWinTheRace) {
+    MiniHttpServer failing;
+    MiniHttpServer slow;
+    failing.setResponseDelay(std::chrono::milliseconds(200));
+    failing.setDropResponses(true);
+    slow.setResponseDelay(std::chrono::milliseconds(400));
+
+    const std::string failingUrl = "http://127.0.0.1:" + std::to_string(failing.port());
+    const std::string slowUrl = "http://127.0.0.1:" + std::to_string(slow.port());
+    unleash::ClientConfig cfg(failingUrl, "dummy-client-key", "unitApp");
+    cfg.setUrls({failingUrl, slowUrl}).setFetchHedging(0.95, std::chrono::milliseconds(50));
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    // The primary fails at ~200 ms; the hedge, fired at 50 ms, answers at ~450 ms and is the result.
+    auto r = fetcher.fetch(ctx);
+    EXPECT_EQ(r.status, 200);
+    EXPECT_TRUE(r.hedged);
+    EXPECT_EQ(r.endpoint, 1u);
+    // Answered by the hedge, not by a failover request after the primary failed:
+    EXPECT_EQ(slow.obs().requests.load(), 1);
+    EXPECT_EQ(failing.obs().requests.load(), 1);
+}
+
+TEST(ToggleFetcher, RacesInARowShareTheHedgeHelper) {
+    MiniHttpServer slow;
+    MiniHttpServer fast;
+    slow.setResponseDelay(std::chrono::milliseconds(300));
+
+    const std::string slowUrl = "http://127.0.0.1:" + std::to_string(slow.port());
+    const std::string fastUrl = "http://127.0.0.1:" + std::to_string(fast.port());
+    unleash::ClientConfig cfg(slowUrl, "dummy-client-key", "unitApp");
+    cfg.setUrls({slowUrl, fastUrl}).setFetchHedging(0.95, std::chrono::milliseconds(20));
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    // Races of every kind in a row (hedge wins, primary wins, cancelled) on the same helper:
+    auto r = fetcher.fetch(ctx);
+    EXPECT_TRUE(r.hedged);
+    for (int i = 0; i < 20; ++i) {
+        r = fetcher.fetch(ctx);
+        EXPECT_FALSE(r.error.has_value());
+    }
+    IComClient::CancelToken cancel{true};
+    r = fetcher.fetch(ctx, &cancel);
+    EXPECT_TRUE(r.error.has_value());
+    r = fetcher.fetch(ctx);
+    EXPECT_FALSE(r.error.has_value());
+}
+
+TEST(ToggleFetcher, CancelAbortsBothHedgedRequests) {
+    // The hedge is in flight when the caller cancels: neither aborted request may be taken for an answer.
+    MiniHttpServer server;
+    server.setResponseDelay(std::chrono::milliseconds(2000));
+
+    const std::string baseUrl = "http://127.0.0.1:" + std::to_string(server.port());
+    unleash::ClientConfig cfg(baseUrl, "dummy-client-key", "unitApp");
+    cfg.setFetchHedging(0.95, std::chrono::milliseconds(20));
+    unleash::Context ctx("unitApp", "dev", "sess-1");
+    unleash::ToggleFetcher fetcher(cfg);
+
+    IComClient::CancelToken cancel{false};
+    std::thread stopper([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        cancel.store(true);
+        fetcher.interrupt();
+    });
+    const auto started = std::chrono::steady_clock::now();
+    auto r = fetcher.fetch(ctx, &cancel);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    stopper.join();
+
+    EXPECT_TRUE(r.error.has_value());
+    EXPECT_FALSE(r.hedged);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+}
@@ -0,0 +1,528 @@
+#include <gtest/gtest.h>
+
+#include "unleash/Client/unleashClient.hpp"
+#include "unleash/Configuration/clientConfig.hpp"
+#include "unleash/Store/fileWatchStorageProvider.hpp"
+#include "unleash/Store/sharedToggleSegment.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Stand-in for the frontend API, one thread per connection. Toggle requests are answered with a single enabled
+// toggle named "u-<userId>" (plus optional padding toggles) and the ETag "e-<userId>" (304 when If-None-Match
+// matches), so that a response tells which context it was built for. Metrics POSTs are answered with 202 and
+// recorded, HEAD requests (connection warm-up) with an empty 200. Fetches and metrics requests can be stalled: the
+// connection is then held open without answer until the client drops it or the stall is lifted.
+class StandInServer {
+  public:
+    StandInServer() {
+        _listen = ::socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        ::setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (::bind(_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(_listen, 32) != 0 ||
+            ::getsockname(_listen, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+            throw std::runtime_error("stand-in server: listen failed");
+        _port = ntohs(addr.sin_port);
+        _acceptor = std::thread([this] { acceptLoop(); });
+    }
+
+    ~StandInServer() {
+        _running.store(false);
+        _acceptor.join();
+        std::vector<std::thread> connections;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            connections.swap(_connections);
+        }
+        for (auto& connection : connections)
+            connection.join();
+        ::close(_listen);
+    }
+
+    std::string url() const {
+        return "http://127.0.0.1:" + std::to_string(_port) + "/api/frontend";
+    }
+
+    // The next p_count fetches are held open without answer until the client drops them.
+    void stallNextFetches(int p_count) {
+        _fetchesToStall.store(p_count);
+    }
+    // Same ETag for every context, as a server whose toggles do not depend on it would send.
+    void setSharedEtag(bool p_shared) {
+        _sharedEtag.store(p_shared);
+    }
+    // Extra toggles in every 200, making the response slow to decode.
+    void setPadding(int p_toggles) {
+        _padding.store(p_toggles);
+    }
+    void setFetchDelay(std::chrono::milliseconds p_delay) {
+        _fetchDelayMs.store(p_delay.count());
+    }
+    void setStallMetrics(bool p_stall) {
+        _stallMetrics.store(p_stall);
+    }
+
+    int fetches() const {
+        return _fetches.load();
+    }
+    // Toggle responses fully handed to the socket.
+    int answered() const {
+        return _answered.load();
+    }
+    int stalledMetrics() const {
+        return _stalledMetrics.load();
+    }
+    std::vector<std::string> fetchLines() const {
+        std::lock_guard<std::mutex> lk(_mutex);
+        return _fetchLines;
+    }
+    std::vector<std::string> metricsBodies() const {
+        std::lock_guard<std::mutex> lk(_mutex);
+        return _metricsBodies;
+    }
+
+    // Polls p_condition until it holds or p_timeout elapses.
+    static bool waitFor(const std::function<bool()>& p_condition, std::chrono::milliseconds p_timeout = 3000ms) {
+        const auto until = std::chrono::steady_clock::now() + p_timeout;
+        while (!p_condition()) {
+            if (std::chrono::steady_clock::now() > until)
+                return false;
+            std::this_thread::sleep_for(5ms);
+        }
+        return true;
+    }
+
+  private:
+    void acceptLoop() {
+        pollfd fd{_listen, POLLIN, 0};
+        while (_running.load()) {
+            if (::poll(&fd, 1, 20) <= 0)
+                continue;
+            const int client = ::accept(_listen, nullptr, nullptr);
+            if (client < 0)
+                continue;
+            std::lock_guard<std::mutex> lk(_mutex);
+            _connections.emplace_back([this, client] { serve(client); });
+        }
+    }
+
+    // Waits until the client closes the connection, p_stall is cleared or the server stops.
+    void holdOpen(int p_client, const std::atomic<bool>& p_stall) {
+        char buf[256];
+        pollfd fd{p_client, POLLIN, 0};
+        while (_running.load() && p_stall.load()) {
+            if (::poll(&fd, 1, 20) > 0 && ::recv(p_client, buf, sizeof(buf), 0) <= 0)
+                return;
+        }
+    }
+
+    void serve(int p_client) {
+        std::string request;
+        char buf[4096];
+        std::size_t headerEnd;
+        while ((headerEnd = request.find("\r\n\r\n")) == std::string::npos) {
+            const auto n = ::recv(p_client, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                ::close(p_client);
+                return;
+            }
+            request.append(buf, static_cast<std::size_t>(n));
+        }
+        std::string lower = request.substr(0, headerEnd);
+        for (auto& c : lower)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        std::size_t bodyLength = 0;
+        if (auto at = lower.find("content-length:"); at != std::string::npos)
+            bodyLength = std::stoul(lower.substr(at + 15));
+        while (request.size() < headerEnd + 4 + bodyLength) {
+            const auto n = ::recv(p_client, buf, sizeof(buf), 0);
+            if (n <= 0)
+                break;
+            request.append(buf, static_cast<std::size_t>(n));
+        }
+        const std::string line = request.substr(0, request.find("\r\n"));
+        const bool head = line.rfind("HEAD ", 0) == 0;
+
+        if (line.find("/client/metrics") != std::string::npos) {
+            if (_stallMetrics.load()) {
+                ++_stalledMetrics;
+                holdOpen(p_client, _stallMetrics);
+            } else if (head) {
+                reply(p_client, "200 OK", "", "");
+            } else {
+                {
+                    std::lock_guard<std::mutex> lk(_mutex);
+                    _metricsBodies.push_back(request.substr(headerEnd + 4));
+                }
+                reply(p_client, "202 Accepted", "", "");
+            }
+            ::close(p_client);
+            return;
+        }
+
+        if (head) {
+            reply(p_client, "200 OK", "", "");
+            ::close(p_client);
+            return;
+        }
+        ++_fetches;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _fetchLines.push_back(line);
+        }
+        if (_fetchesToStall.fetch_sub(1) > 0) {
+            holdOpen(p_client, _running);
+            ::close(p_client);
+            return;
+        }
+        const auto delayUntil = std::chrono::steady_clock::now() + std::chrono::milliseconds(_fetchDelayMs.load());
+        while (_running.load() && std::chrono::steady_clock::now() < delayUntil)
+            std::this_thread::sleep_for(5ms);
+
+        std::string user = "none";
+        if (auto at = line.find("userId="); at != std::string::npos)
+            user = line.substr(at + 7, line.find_first_of("& ", at) - at - 7);
+        const std::string etag = _sharedEtag.load() ? "\"e-shared\"" : "\"e-" + user + "\"";
+        if (lower.find("if-none-match: " + etag) != std::string::npos) {
+            reply(p_client, "304 Not Modified", etag, "");
+        } else {
+            std::string body = R"({"toggles":[{"name":"u-)" + user + R"(","enabled":true})";
+            for (int i = 0, padding = _padding.load(); i < padding; ++i)
+                body += R"(,{"name":"pad-)" + std::to_string(i) + R"(","enabled":false})";
+            reply(p_client, "200 OK", etag, body + "]}");
+        }
+        ++_answered;
+        ::close(p_client);
+    }
+
+    static void reply(int p_client, const std::string& p_status, const std::string& p_etag, const std::string& p_body) {
+        std::string response = "HTTP/1.1 " + p_status + "\r\nConnection: close\r\nContent-Type: application/json\r\n";
+        if (!p_etag.empty())
+            response += "ETag: " + p_etag + "\r\n";
+        response += "Content-Length: " + std::to_string(p_body.size()) + "\r\n\r\n" + p_body;
+        ::send(p_client, response.data(), response.size(), MSG_NOSIGNAL);
+    }
+
+    int _listen = -1;
+    int _port = 0;
+    std::atomic<bool> _running{true};
+    std::atomic<int> _fetchesToStall{0};
+    std::atomic<bool> _sharedEtag{false};
+    std::atomic<int> _padding{0};
+    std::atomic<int> _answered{0};
+    std::atomic<long long> _fetchDelayMs{0};
+    std::atomic<bool> _stallMetrics{false};
+    std::atomic<int> _fetches{0};
+    std::atomic<int> _stalledMetrics{0};
+    std::thread _acceptor;
+    mutable std::mutex _mutex;
+    std::vector<std::thread> _connections;
+    std::vector<std::string> _fetchLines;
+    std::vector<std::string> _metricsBodies;
+};
+
+int countContaining(const std::vector<std::string>& p_items, const std::string& p_needle) {
+    int count = 0;
+    for (const auto& item : p_items)
+        count += item.find(p_needle) != std::string::npos ? 1 : 0;
+    return count;
+}
+
+} // namespace
+
+TEST(UnleashClient, ForkChildDoesNotResendTheParentsMetrics) {
+    StandInServer server;
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(0s).setMetricsInterval(1s);
+    cfg.setBootstrap(unleash::Bootstrap({{"counted-flag", unleash::Toggle("counted-flag", true)}}));
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    client.start();
+    ASSERT_TRUE(client.isEnabled("counted-flag"));
+
+    const pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        // Give the child's metrics task a couple of rounds; the window it inherited belongs to the parent.
+        std::this_thread::sleep_for(2500ms);
+        ::_exit(0);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(StandInServer::waitFor([&] { return !server.metricsBodies().empty(); }));
+    std::this_thread::sleep_for(300ms);
+    client.stop();
+
+    EXPECT_EQ(countContaining(server.metricsBodies(), "counted-flag"), 1);
+}
+
+TEST(UnleashClient, ForkChildPollsAndSendsMetricsAgain) {
+    StandInServer server;
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(1s).setMetricsInterval(1s);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    client.start();
+    ASSERT_TRUE(StandInServer::waitFor([&] { return server.answered() == 1; }));
+
+    const pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        // The toggle the stand-in server answers with, which the parent never evaluates:
+        client.isEnabled("u-none");
+        std::this_thread::sleep_for(3000ms);
+        ::_exit(0);
+    }
+    // From now on, every request comes from the child.
+    client.stop();
+    std::this_thread::sleep_for(100ms);
+    const int parentFetches = server.fetches();
+
+    EXPECT_TRUE(StandInServer::waitFor([&] { return server.fetches() > parentFetches; }));
+    EXPECT_TRUE(StandInServer::waitFor([&] { return countContaining(server.metricsBodies(), "u-none") > 0; }));
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+}
+
+TEST(UnleashClient, ForkWaitsForTheFetchInFlight) {
+    StandInServer server;
+    server.setFetchDelay(500ms);
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(60s).setMetricsInterval(0s);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    client.start();
+    ASSERT_TRUE(StandInServer::waitFor([&] { return server.fetches() == 1; }));
+
+    // The fetch is neither aborted nor repeated: both sides come out of fork() with its toggles.
+    const pid_t pid = ::fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0)
+        ::_exit(client.isReady() ? 0 : 1);
+    EXPECT_TRUE(client.isReady());
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(server.fetches(), 1);
+    EXPECT_EQ(server.answered(), 1);
+    client.stop();
+}
+
+TEST(UnleashClient, EvaluationsWithoutImpressionListenerDoNotUseTheSampler) {
+    unleash::ClientConfig cfg("http://127.0.0.1:1/api/frontend", "key", "client-test");
+    cfg.setRefreshInterval(0s).setMetricsInterval(0s).setImpressionFirstN(1, std::chrono::hours(1));
+    cfg.setBootstrap(unleash::Bootstrap({{"seen-flag", unleash::Toggle("seen-flag", true, true)}}));
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    client.start();
+
+    // Nobody listens: these do not take the only impression of the interval.
+    for (int i = 0; i < 3; ++i)
+        ASSERT_TRUE(client.isEnabled("seen-flag"));
+
+    std::mutex mutex;
+    std::vector<std::uint64_t> suppressed;
+    client.addImpressionListener([&](const unleash::ClientImpression& p_impression) {
+        std::lock_guard<std::mutex> lk(mutex);
+        suppressed.push_back(p_impression.suppressed);
+    });
+    ASSERT_TRUE(client.isEnabled("seen-flag"));
+    EXPECT_TRUE(StandInServer::waitFor([&] {
+        std::lock_guard<std::mutex> lk(mutex);
+        return !suppressed.empty();
+    }));
+    client.stop();
+
+    ASSERT_EQ(suppressed.size(), 1u);
+    EXPECT_EQ(suppressed[0], 0u);
+}
+
+TEST(UnleashClient, BurstOfContextUpdatesWithinTheDebounceWindowFetchesOnce) {
+    StandInServer server;
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(60s).setMetricsInterval(0s).setContextUpdateDebounce(300ms);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    client.start();
+    ASSERT_TRUE(StandInServer::waitFor([&] { return client.isReady(); }));
+    ASSERT_EQ(server.fetches(), 1);
+
+    for (const char* user : {"b1", "b2", "b3", "b4", "b5"}) {
+        client.updateContext(unleash::MutableContext{}.setUserId(user));
+        std::this_thread::sleep_for(20ms);
+    }
+    // Same context again: not an update.
+    client.updateContext(unleash::MutableContext{}.setUserId("b5"));
+
+    ASSERT_TRUE(StandInServer::waitFor([&] { return client.isEnabled("u-b5"); }));
+    std::this_thread::sleep_for(500ms);
+    client.stop();
+
+    const auto lines = server.fetchLines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[1].find("userId=b5"), std::string::npos);
+}
+
+TEST(UnleashClient, FirstFetchDoesNotWaitForTheMetricsWarmUp) {
+    StandInServer server;
+    server.setStallMetrics(true);
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(60s).setMetricsInterval(60s).setPreconnect(true).setTimeOutQueryMS(5000ms);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    client.start();
+
+    // The metrics connection hangs for the whole timeout; the fetch path only waits for its own warm-up.
+    EXPECT_TRUE(StandInServer::waitFor([&] { return client.isReady(); }, 2000ms));
+    EXPECT_EQ(server.stalledMetrics(), 1);
+    server.setStallMetrics(false);
+    client.stop();
+}
+
+TEST(UnleashClient, UpdateContextAbortsAStalledFetch) {
+    StandInServer server;
+    server.stallNextFetches(1);
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(60s).setMetricsInterval(0s).setTimeOutQueryMS(10000ms);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    std::atomic<int> errors{0};
+    client.onError([&](const auto&) { ++errors; });
+    client.start();
+    ASSERT_TRUE(StandInServer::waitFor([&] { return server.fetches() == 1; }));
+
+    // Without the abort, the next fetch would wait for the 10 s timeout of the stalled one.
+    client.updateContext(unleash::MutableContext{}.setUserId("moved"));
+    EXPECT_TRUE(StandInServer::waitFor([&] { return client.isEnabled("u-moved"); }, 2000ms));
+    client.stop();
+
+    EXPECT_EQ(server.fetches(), 2);
+    EXPECT_EQ(errors.load(), 0); // superseded, not failed
+}
+
+TEST(UnleashClient, ResponseForAStaleContextIsDroppedWithItsEtag) {
+    StandInServer server;
+    // Same ETag for both contexts: a 304 against the dropped response would keep the client without toggles.
+    server.setSharedEtag(true);
+    server.setPadding(50000);
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(60s).setMetricsInterval(0s).setTimeOutQueryMS(10000ms);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    std::atomic<int> updates{0};
+    client.onUpdate([&] { ++updates; });
+    client.start();
+
+    // The response is on its way (and slow to decode) when the context changes.
+    ASSERT_TRUE(StandInServer::waitFor([&] { return server.answered() == 1; }));
+    std::this_thread::sleep_for(20ms);
+    client.updateContext(unleash::MutableContext{}.setUserId("moved"));
+
+    ASSERT_TRUE(StandInServer::waitFor([&] { return server.fetches() == 2; }, 5000ms));
+    EXPECT_TRUE(StandInServer::waitFor([&] { return client.isEnabled("u-moved"); }, 5000ms));
+    client.stop();
+    EXPECT_EQ(updates.load(), 1); // the stale toggles were never applied
+
+    const auto lines = server.fetchLines();
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[1].find("userId=moved"), std::string::npos);
+}
+
+TEST(UnleashClient, FetchCircuitCoversEveryEndpoint) {
+    // Nothing listens on port 1: both endpoints refuse the connection.
+    unleash::ClientConfig cfg("http://127.0.0.1:1/a", "key", "client-test");
+    cfg.setUrls({"http://127.0.0.1:1/a", "http://127.0.0.1:1/b"});
+    cfg.setRefreshInterval(60s).setMetricsInterval(0s).setCircuitBreaker(1, 60000ms);
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    std::mutex mutex;
+    std::vector<unleash::CircuitStateChange> changes;
+    client.onCircuitStateChange([&](const unleash::CircuitStateChange& p_change) {
+        std::lock_guard<std::mutex> lk(mutex);
+        changes.push_back(p_change);
+    });
+    client.start();
+    ASSERT_TRUE(StandInServer::waitFor([&] {
+        std::lock_guard<std::mutex> lk(mutex);
+        return !changes.empty();
+    }));
+    client.stop();
+
+    std::lock_guard<std::mutex> lk(mutex);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].endpoint, "http://127.0.0.1:1/a, http://127.0.0.1:1/b");
+    EXPECT_EQ(changes[0].to, unleash::CircuitState::Open);
+}
+
+TEST(UnleashClient, PollingClientIgnoresItsOwnBackupWrites) {
+    StandInServer server;
+    const auto dir = std::filesystem::temp_directory_path() / ("unleash-client-test-" + std::to_string(::getpid()));
+
+    unleash::ClientConfig cfg(server.url(), "key", "client-test");
+    cfg.setRefreshInterval(60s).setMetricsInterval(0s);
+    cfg.setStorageProvider(std::make_shared<unleash::FileWatchStorageProvider>("client-test", dir.string()));
+    {
+        unleash::UnleashClient client(cfg, unleash::Context{});
+        std::atomic<int> updates{0};
+        client.onUpdate([&] { ++updates; });
+        client.start();
+        ASSERT_TRUE(StandInServer::waitFor([&] { return client.isReady(); }));
+        // The fetch is persisted to the watched file: the watcher must not apply it a second time.
+        std::this_thread::sleep_for(500ms);
+        client.stop();
+        EXPECT_EQ(updates.load(), 1);
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
+
+TEST(UnleashClient, SegmentReaderFollowsPublicationsWithoutEvaluating) {
+    const std::string name = "unleash-client-test-" + std::to_string(::getpid());
+    auto publisher = unleash::SharedToggleSegment::create(name, 4096);
+    ASSERT_NE(publisher, nullptr);
+    auto publish = [&](bool p_enabled) {
+        unleash::ToggleSet::Map toggles;
+        toggles.emplace("seg-flag", unleash::Toggle("seg-flag", p_enabled));
+        return publisher->publish(unleash::ToggleSet(std::move(toggles)));
+    };
+    ASSERT_TRUE(publish(false));
+
+    unleash::ClientConfig cfg("http://127.0.0.1:1/api/frontend", "key", "client-test");
+    cfg.setRefreshInterval(0s).setMetricsInterval(0s).setSharedToggleSegment(unleash::SharedToggleSegment::open(name));
+    // isReady() picks up the published snapshot by itself, even on a client that is not started:
+    EXPECT_TRUE(unleash::UnleashClient(cfg, unleash::Context{}).isReady());
+
+    unleash::UnleashClient client(cfg, unleash::Context{});
+    std::atomic<int> updates{0};
+    client.onUpdate([&] { ++updates; });
+    client.start();
+    ASSERT_TRUE(StandInServer::waitFor([&] { return updates.load() == 1; }));
+    ASSERT_TRUE(publish(true));
+    // The next one comes from the background refresh, with neither an evaluation nor isReady() in between:
+    EXPECT_TRUE(StandInServer::waitFor([&] { return updates.load() == 2; }));
+    EXPECT_TRUE(client.isEnabled("seg-flag"));
+    client.stop();
+    unleash::SharedToggleSegment::remove(name);
+}
+
+#endif